@@ -1,4 +1,7 @@
 #include "DynamicBandpassFilter.h"
+#include "FFTBackend.h"
+#include "KaiserWindow.h"
+#include "KernelFile.h"
 #include <chrono>
 #include <cstring>
 #include <stdexcept>
@@ -6,6 +9,7 @@
 #include <thread>
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 #include <QDebug>
 
 #ifndef M_PI
@@ -31,26 +35,127 @@ static const ProtocolDefaults PROTOCOL_DEFAULTS[] = {
 
 static const char* protocol_names[] = {"WFM", "NBFM", "AM", "USB", "LSB"};
 
+// Spectrum tap limits
+static const int SPECTRUM_TAP_MAX_BINS = 4096;
+static const int SPECTRUM_TAP_FRESH = 0x4;
+
+// Band scan noise floor: this quantile of up to SCAN_NOISE_MAX_BINS evenly spaced bins,
+// re-estimated every SCAN_NOISE_INTERVAL_BLOCKS blocks
+static const float SCAN_NOISE_QUANTILE = 0.25f;
+static const int SCAN_NOISE_MAX_BINS = 1024;
+static const int SCAN_NOISE_INTERVAL_BLOCKS = 8;
+static const int SCAN_REPORT_FRESH = 0x4;
+
+// AFC: shortest interval between kernel retunes
+static const double AFC_MIN_RETUNE_SECONDS = 0.25;
+
+// Auto notch: persistence counters saturate here, so the latch point stays below it
+static const int NOTCH_COUNTER_MAX = 65535;
+static const int NOTCH_MAX_PERSISTENCE_BLOCKS = NOTCH_COUNTER_MAX / 2;
+
+// cu8 sample value -> float, centred on 127.5 so both rails map to +/-1
+static float cu8ToFloat(int value) {
+    return (static_cast<float>(value) - 127.5f) / 127.5f;
+}
+
+// Noise reduction gain smoothing across frames: rising gains follow quickly so onsets are
+// not clipped, falling gains slowly so the mask does not flutter from frame to frame
+static const float NR_GAIN_ATTACK = 0.6f;
+static const float NR_GAIN_RELEASE = 0.2f;
+
+// Response analysis tone counts
+static const int ANALYSIS_PASSBAND_TONES = 32;
+static const int ANALYSIS_STOPBAND_TONES = 64;
+static const int ANALYSIS_SIDEBAND_TONES = 16;
+
+// FFT size search range for automatic sizing
+static const int MIN_AUTO_FFT_SIZE = 256;
+static const int MAX_AUTO_FFT_SIZE = 1 << 20;
+
+// The frequency-sampled stopband floor and the Kaiser window's sidelobes add, in phase at
+// worst, so each is designed this far below the configured attenuation (20 log10 2)
+static const double KERNEL_DESIGN_MARGIN_DB = 6.02;
+
 DynamicBandpassFilter::DynamicBandpassFilter() 
     : initialized_(false)
     , enabled_(false)
     , parameters_changed_(true)
-    , processing_active_(false)
+    , kernel_retune_pending_(false)
+    , init_state_(UNINITIALIZED)
+    , mute_until_ready_(false)
     , fft_size_(0)
-    , overlap_size_(0)
+    , auto_fft_size_(false)
+    , auto_fft_latency_ms_(50.0)
+    , required_kernel_length_(0)
     , frequency_resolution_(0.0f)
-    , forward_plan_(nullptr)
-    , inverse_plan_(nullptr)
     , fft_input_(nullptr)
     , fft_output_(nullptr)
+    , fft_capacity_(0)
+    , max_fft_size_(0)
+    , reconfigure_pending_(false)
+    , pre_decimation_enabled_(false)
+    , pre_decimation_(1)
+    , nr_window_pos_(0)
+    , nr_window_fill_(0)
+    , nr_new_samples_(0)
+    , kernel_length_(1)
+    , kernel_designed_(false)
+    , designed_protocol_(WFM)
+    , designed_low_hz_(0.0f)
+    , designed_high_hz_(0.0f)
+    , designed_carrier_hz_(0.0f)
     , passband_low_hz_(0.0f)
     , passband_high_hz_(0.0f)
     , current_center_freq_(0.0f)
+    , group_delay_samples_(0.0f)
     , ssb_carrier_offset_(0.0f)
     , ssb_sharp_cutoff_(false)
+    , ssb_demod_phase_(0.0)
     , energy_history_idx_(0)
     , adaptive_alpha_(0.05f)
+    , afc_enabled_(false)
+    , afc_offset_hz_(0.0f)
+    , afc_max_offset_hz_(2000.0f)
+    , afc_smoothed_error_(0.0f)
+    , afc_blocks_since_retune_(0)
+    , pending_center_freq_(0.0f)
+    , pending_center_changes_(0)
+    , auto_notch_enabled_(false)
+    , notch_threshold_(31.6f)
+    , notch_persistence_seconds_(0.2f)
+    , notch_max_count_(8)
+    , active_notch_count_(0)
+    , spectrum_middle_(1)
+    , spectrum_back_(0)
+    , spectrum_front_(2)
+    , spectrum_tap_enabled_(false)
+    , spectrum_tap_bins_(1024)
+    , spectrum_tap_average_(4)
+    , spectrum_accum_blocks_(0)
+    , spectrum_accum_bins_(0)
+    , spectrum_sequence_(0)
+    , scan_enabled_(false)
+    , scan_max_frequency_hz_(0.0f)
+    , scan_ranges_fft_size_(0)
+    , scan_ranges_resolution_(0.0f)
+    , scan_activity_snr_db_(10.0f)
+    , scan_noise_bin_power_(1e-30f)
+    , scan_blocks_since_noise_(0)
+    , scan_noise_warmup_blocks_(0)
+    , scan_sequence_(0)
+    , scan_middle_(1)
+    , scan_back_(0)
+    , scan_front_(2)
+    , measured_signal_dbfs_(-200.0f)
+    , measured_noise_dbfs_(-200.0f)
+    , measured_peak_dbfs_(-200.0f)
+    , measured_peak_freq_hz_(0.0f)
+    , measured_block_sequence_(0)
     , total_samples_processed_(0) 
+    , total_samples_bypassed_(0)
+    , pool_exhausted_drops_(0)
+    , oversized_input_drops_(0)
+    , stats_sequence_(0)
 {
     // Initialize default configuration for WFM
     config_.protocol = WFM;
@@ -61,74 +166,441 @@ DynamicBandpassFilter::DynamicBandpassFilter()
     config_.sample_rate = 2048000.0;
     config_.ssb_carrier_offset = 0.0f;
     config_.ssb_sharp_cutoff = false;
+    config_.minimum_phase = false;
     
     // Initialize energy history for adaptive centering
     energy_history_.resize(32, 0.0f);
     
+    // Preallocate spectrum tap slots so publishing never allocates
+    for (auto& slot : spectrum_slots_) {
+        slot.magnitude_db.assign(SPECTRUM_TAP_MAX_BINS, -200.0f);
+        slot.bins = 0;
+        slot.sequence = 0;
+        slot.span_hz = 0.0;
+        slot.center_hz = 0.0;
+    }
+    spectrum_accum_.assign(SPECTRUM_TAP_MAX_BINS, 0.0f);
+    
     // Initialize statistics
     current_stats_ = {};
     current_stats_.is_enabled = false;
     current_stats_.ssb_mode_active = false;
+    current_stats_.fft_backend = FFTBackend::kindName(FFTBackend::KIND_COUNT);
+    for (auto& word : published_stats_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        publishStatsLocked();
+    }
     
     qDebug() << "DynamicBandpassFilter: Created with default WFM configuration";
 }
 
 DynamicBandpassFilter::~DynamicBandpassFilter() {
-    // Wait for any active processing to complete
-    while (processing_active_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // A background initialization still owns the engine
+    {
+        std::lock_guard<std::mutex> init_lock(init_thread_mutex_);
+        if (init_thread_.joinable()) {
+            init_thread_.join();
+        }
     }
+    
+    // Wait for the last block in flight; the gate stays shut for good
+    processing_gate_.close();
     cleanup();
 }
 
-bool DynamicBandpassFilter::initialize(int sample_rate, int fft_size) {
+static bool validInitParameters(int sample_rate, int fft_size) {
     if (sample_rate <= 0 || fft_size < 256 || (fft_size & (fft_size - 1)) != 0) {
         qDebug() << "DynamicBandpassFilter: Invalid parameters - sample_rate:" << sample_rate << "fft_size:" << fft_size;
         return false;
     }
+    return true;
+}
+
+bool DynamicBandpassFilter::initialize(int sample_rate, int fft_size) {
+    if (!validInitParameters(sample_rate, fft_size)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> init_lock(init_thread_mutex_);
+    if (init_thread_.joinable()) {
+        init_thread_.join();
+    }
+    
+    init_state_.store(INITIALIZING);
+    bool success = initializeEngine(sample_rate, fft_size);
+    init_state_.store(success ? READY : FAILED);
+    return success;
+}
+
+bool DynamicBandpassFilter::initializeAsync(int sample_rate, int fft_size, bool mute_until_ready) {
+    if (!validInitParameters(sample_rate, fft_size)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> init_lock(init_thread_mutex_);
+    if (init_thread_.joinable()) {
+        init_thread_.join();
+    }
+    
+    // From here on process() stops touching the engine
+    mute_until_ready_.store(mute_until_ready);
+    init_state_.store(INITIALIZING);
+    
+    init_thread_ = std::thread([this, sample_rate, fft_size]() {
+        auto start_time = std::chrono::steady_clock::now();
+        
+        // Benchmark and plan before taking any filter lock; initializeEngine() then hits the caches
+        FFTBackendSelector::instance().select(fft_size);
+        
+        bool success = initializeEngine(sample_rate, fft_size);
+        if (success) {
+            // Design now rather than on the first block after the switch
+            updateFilterParameters();
+        }
+        init_state_.store(success ? READY : FAILED);
+        
+        double elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time).count();
+        qDebug() << "DynamicBandpassFilter: Background initialization" << (success ? "ready" : "failed")
+                 << "after" << elapsed_ms << "ms";
+    });
+    
+    qDebug() << "DynamicBandpassFilter: Initializing in background -" << fft_size << "bins,"
+             << (mute_until_ready ? "muted" : "passing through") << "until ready";
+    return true;
+}
+
+DynamicBandpassFilter::InitState DynamicBandpassFilter::waitForInitialization() {
+    std::lock_guard<std::mutex> init_lock(init_thread_mutex_);
+    if (init_thread_.joinable()) {
+        init_thread_.join();
+    }
+    return init_state_.load();
+}
+
+DynamicBandpassFilter::KernelDesignScratch::KernelDesignScratch()
+    : buffer(nullptr)
+    , size(0)
+    , window_beta(-1.0f)
+{
+}
+
+DynamicBandpassFilter::KernelDesignScratch::~KernelDesignScratch() {
+    if (buffer) fftwf_free(buffer);
+}
+
+bool DynamicBandpassFilter::KernelDesignScratch::prepare(int fft_size) {
+    if (fft_size == size && backend && buffer) return true;
+    
+    if (buffer) fftwf_free(buffer);
+    buffer = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size);
+    backend = FFTBackendSelector::instance().createFastest(fft_size);
+    size = (buffer && backend) ? fft_size : 0;
+    return size > 0;
+}
+
+DynamicBandpassFilter::PendingReconfiguration::PendingReconfiguration()
+    : sample_rate(0)
+    , fft_size(0)
+    , decimation(1)
+    , frequency_resolution(0.0f)
+    , required_kernel_length(0)
+    , backend_us(0.0)
+    , design()
+    , fft_input(nullptr)
+    , fft_output(nullptr)
+    , fft_capacity(0)
+{
+}
+
+DynamicBandpassFilter::PendingReconfiguration::~PendingReconfiguration() {
+    if (fft_input) fftwf_free(fft_input);
+    if (fft_output) fftwf_free(fft_output);
+}
+
+void DynamicBandpassFilter::setMaxFFTSize(int max_fft_size) {
+    max_fft_size_.store(std::max(max_fft_size, 0));
+}
+
+bool DynamicBandpassFilter::reconfigure(int sample_rate, int fft_size) {
+    if (!validInitParameters(sample_rate, fft_size)) {
+        return false;
+    }
+    if (init_state_.load() != READY) {
+        return initialize(sample_rate, fft_size);
+    }
+    
+    auto start_time = std::chrono::steady_clock::now();
+    
+    std::unique_ptr<PendingReconfiguration> pending(new PendingReconfiguration());
+    pending->sample_rate = sample_rate;
+    pending->fft_size = fft_size;
+    
+    FilterConfig config_copy;
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        config_copy = config_;
+    }
+    config_copy.sample_rate = sample_rate;
+    int decimation = computePreDecimation(config_copy);
+    pending->decimation = decimation;
+    double processing_rate = static_cast<double>(sample_rate) / decimation;
+    pending->frequency_resolution = static_cast<float>(processing_rate / fft_size);
+    
+    // Always staged: the running factor can change (updatePreDecimation()) before the swap,
+    // so whether the front end needs replacing is only decided when it is applied
+    pending->decimator.configure(decimation);
+    
+    // Backend selection and FFTW plans are cached per size - repeat visits are cheap
+    FFTBackendSelector::Selection selection;
+    pending->backend = FFTBackendSelector::instance().createFastest(fft_size, &selection);
+    if (!pending->backend) {
+        qDebug() << "DynamicBandpassFilter: Reconfigure failed - no FFT backend for size" << fft_size;
+        return false;
+    }
+    pending->backend_us = selection.microseconds;
+    
+    KernelDesignScratch scratch;
+    pending->kernel.assign(fft_size, std::complex<float>(1.0f, 0.0f));
+    pending->design = designKernelInto(pending->kernel, fft_size, pending->frequency_resolution, config_copy, false,
+                                       decimation, scratch);
+    computeKernelBands(pending->kernel.data(), fft_size, pending->kernel_bands);
+    pending->nr_gains.assign(fft_size, 1.0f);
+    pending->nr_smoothed_gains.assign(fft_size, 1.0f);
+    pending->nr_window.assign(fft_size, std::complex<float>(0.0f, 0.0f));
+    
+    const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(config_copy.protocol)];
+    pending->required_kernel_length = selectFFTSize(processing_rate, config_copy.bandwidth, defaults.transition_width,
+                                                    config_copy.stopband_attenuation, 0.0).kernel_length;
+    
+    // Grow the buffers only past the reserved capacity
+    if (fft_size > fft_capacity_.load()) {
+        int capacity = std::max(fft_size, max_fft_size_.load());
+        pending->fft_input = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * capacity);
+        pending->fft_output = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * capacity);
+        if (!pending->fft_input || !pending->fft_output) {
+            qDebug() << "DynamicBandpassFilter: Reconfigure failed - cannot allocate" << capacity << "bins";
+            return false;
+        }
+        memset(pending->fft_input, 0, sizeof(fftwf_complex) * capacity);
+        memset(pending->fft_output, 0, sizeof(fftwf_complex) * capacity);
+        pending->fft_capacity = capacity;
+        pending->overlap_history.reserve(capacity / 2);
+    }
+    
+    {
+        std::lock_guard<std::mutex> reconfigure_lock(reconfigure_mutex_);
+        pending_reconfiguration_ = std::move(pending);   // Replaces one not yet picked up
+        reconfigure_pending_.store(true);
+    }
+    
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+    qDebug() << "DynamicBandpassFilter: Reconfiguration staged -" << sample_rate << "Hz," << fft_size
+             << "bins, decimation" << decimation << "- prepared in" << elapsed_ms << "ms";
+    return true;
+}
+
+std::unique_ptr<DynamicBandpassFilter::PendingReconfiguration> DynamicBandpassFilter::applyPendingReconfiguration() {
+    // Processing thread, between blocks: only pointer swaps and atomic stores from here on.
+    // The replaced resources come back in the returned object for the caller to free.
+    std::unique_ptr<PendingReconfiguration> pending;
+    {
+        std::lock_guard<std::mutex> reconfigure_lock(reconfigure_mutex_);
+        pending = std::move(pending_reconfiguration_);
+        reconfigure_pending_.store(false);
+    }
+    if (!pending) return pending;
+    
+    int fft_size = pending->fft_size;
+    const char* backend_name;
+    {
+        std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+        std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+        
+        if (pending->fft_input) {
+            std::swap(fft_input_, pending->fft_input);
+            std::swap(fft_output_, pending->fft_output);
+            fft_capacity_.store(pending->fft_capacity);
+            
+            // Larger history reservation; the block loop trims it to the new kernel
+            pending->overlap_history.assign(overlap_history_.begin(), overlap_history_.end());
+            overlap_history_.swap(pending->overlap_history);
+        }
+        fft_backend_.swap(pending->backend);
+        backend_name = fft_backend_->name();
+        filter_kernel_.swap(pending->kernel);
+        std::swap(kernel_bands_, pending->kernel_bands);
+        kernel_length_ = pending->design.kernel_length;
+        nr_gains_.swap(pending->nr_gains);
+        nr_smoothed_gains_.swap(pending->nr_smoothed_gains);
+        nr_window_.swap(pending->nr_window);
+        nr_window_pos_ = 0;
+        nr_window_fill_ = 0;
+        nr_new_samples_ = 0;
+        if (noise_reducer_) {
+            noise_reducer_->reset();
+        }
+        
+        mapped_kernel_.reset();
+        kernel_designed_ = true;
+        designed_protocol_ = pending->design.protocol;
+        designed_low_hz_ = pending->design.low_hz;
+        designed_high_hz_ = pending->design.high_hz;
+        designed_carrier_hz_ = pending->design.carrier_hz;
+        
+        // Notch bins are indices into the old FFT
+        notch_bins_.clear();
+        notch_counters_.clear();
+        tracked_notches_.clear();
+        active_notch_count_.store(0);
+        
+        fft_size_.store(fft_size);
+        frequency_resolution_.store(pending->frequency_resolution);
+        required_kernel_length_.store(pending->required_kernel_length);
+        group_delay_samples_.store(pending->design.group_delay_samples);
+    }
+    
+    {
+        // Keep the running front end (and its filter state) when it already has the factor
+        std::lock_guard<std::mutex> decimator_lock(decimator_mutex_);
+        if (pre_decimator_.getDecimation() != pending->decimation) {
+            std::swap(pre_decimator_, pending->decimator);
+        }
+        pre_decimation_.store(pending->decimation);
+    }
+    
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        config_.sample_rate = pending->sample_rate;
+    }
+    
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        current_stats_.fft_backend = backend_name;
+        current_stats_.fft_backend_us = pending->backend_us;
+    }
+    publishDesignStats();
     
-    // Wait for any active processing to complete
-    while (processing_active_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return pending;
+}
+
+size_t DynamicBandpassFilter::outputWhileInitializing(const std::complex<float>* input, size_t count,
+                                                      std::complex<float>* output) {
+    return passThrough(input, count, output, count, mute_until_ready_.load());
+}
+
+size_t DynamicBandpassFilter::passThrough(const std::complex<float>* input, size_t count,
+                                          std::complex<float>* output, size_t capacity, bool mute) {
+    // Unfiltered output still goes through the pre-decimation front end, so every path
+    // returns samples at getOutputSampleRate(). input may alias output.
+    size_t written = runFrontEnd(input, count, output, capacity);
+    if (mute) {
+        std::fill(output, output + written, std::complex<float>(0.0f, 0.0f));
+    }
+    total_samples_bypassed_.fetch_add(count);
+    return written;
+}
+
+size_t DynamicBandpassFilter::runFrontEnd(const std::complex<float>* input, size_t count,
+                                          std::complex<float>* output, size_t capacity) {
+    size_t written = std::min(count, capacity);
+    std::lock_guard<std::mutex> decimator_lock(decimator_mutex_);
+    if (pre_decimator_.getDecimation() > 1) {
+        written = pre_decimator_.process(input, count, output, capacity);
+    } else if (input != output) {
+        std::copy(input, input + written, output);
     }
+    return written;
+}
+
+bool DynamicBandpassFilter::initializeEngine(int sample_rate, int fft_size) {
+    // Wait for the last block in flight; calls arriving meanwhile take the bypass
+    QuiescenceGate::ClosedScope quiesce(processing_gate_);
     
     // Cleanup any existing resources
     cleanup();
     
+    // A full initialization supersedes any reconfigure() still waiting for a block
+    {
+        std::lock_guard<std::mutex> reconfigure_lock(reconfigure_mutex_);
+        pending_reconfiguration_.reset();
+        reconfigure_pending_.store(false);
+    }
+    
     std::lock_guard<std::mutex> state_lock(state_mutex_);
     std::lock_guard<std::mutex> config_lock(config_mutex_);
     std::lock_guard<std::mutex> fft_lock(fft_mutex_);
     
     config_.sample_rate = sample_rate;
     fft_size_.store(fft_size);
-    frequency_resolution_.store(static_cast<float>(sample_rate) / fft_size);
+    
+    // The FFT runs after the pre-decimation front end
+    int decimation = computePreDecimation(config_);
+    {
+        std::lock_guard<std::mutex> decimator_lock(decimator_mutex_);
+        pre_decimator_.configure(decimation);
+    }
+    pre_decimation_.store(decimation);
+    double processing_rate = static_cast<double>(sample_rate) / decimation;
+    frequency_resolution_.store(static_cast<float>(processing_rate / fft_size));
     
     try {
-        // Allocate FFT buffers using fftwf_malloc for better alignment
-        fft_input_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size);
-        fft_output_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size);
+        // Allocate FFT buffers using fftwf_malloc for better alignment, sized for the
+        // largest FFT reconfigure() may switch to
+        int capacity = std::max(fft_size, max_fft_size_.load());
+        fft_input_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * capacity);
+        fft_output_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * capacity);
         
         if (!fft_input_ || !fft_output_) {
             throw std::runtime_error("Failed to allocate FFT buffers");
         }
+        fft_capacity_.store(capacity);
         
         // Initialize buffers to zero
-        memset(fft_input_, 0, sizeof(fftwf_complex) * fft_size);
-        memset(fft_output_, 0, sizeof(fftwf_complex) * fft_size);
+        memset(fft_input_, 0, sizeof(fftwf_complex) * capacity);
+        memset(fft_output_, 0, sizeof(fftwf_complex) * capacity);
+        nr_gains_.reserve(capacity);
+        nr_gains_.assign(fft_size, 1.0f);
+        nr_smoothed_gains_.reserve(capacity);
+        nr_smoothed_gains_.assign(fft_size, 1.0f);
+        nr_window_.reserve(capacity);
+        nr_window_.assign(fft_size, std::complex<float>(0.0f, 0.0f));
+        nr_window_pos_ = 0;
+        nr_window_fill_ = 0;
+        nr_new_samples_ = 0;
+        overlap_history_.reserve(capacity / 2);
+        overlap_history_.clear();
+        notch_counters_.clear();
+        tracked_notches_.clear();
+        if (noise_reducer_) {
+            noise_reducer_->reset();
+        }
         
-        // Create FFT plans with FFTW_ESTIMATE (thread-safe)
-        forward_plan_ = fftwf_plan_dft_1d(fft_size, fft_input_, fft_output_, FFTW_FORWARD, FFTW_ESTIMATE);
-        inverse_plan_ = fftwf_plan_dft_1d(fft_size, fft_output_, fft_input_, FFTW_BACKWARD, FFTW_ESTIMATE);
+        // Fastest backend for this size; benchmarked once per process, FFTW plans are shared
+        FFTBackendSelector::Selection backend_selection;
+        fft_backend_ = FFTBackendSelector::instance().createFastest(fft_size, &backend_selection);
         
-        if (!forward_plan_ || !inverse_plan_) {
-            throw std::runtime_error("Failed to create FFT plans");
+        if (!fft_backend_) {
+            throw std::runtime_error("Failed to create FFT backend");
         }
         
         // Initialize filter kernel - start with all-pass
         {
             std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+            filter_kernel_.reserve(capacity);
             filter_kernel_.resize(fft_size, std::complex<float>(1.0f, 0.0f));
+            kernel_length_ = 1;
+            mapped_kernel_.reset();
+            kernel_designed_ = false;
+            notch_bins_.clear();
+            kernel_bands_.power.reserve(capacity);
+            updateKernelBandsLocked();
         }
+        active_notch_count_.store(0);
         
         // Set initial passband
         const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(config_.protocol)];
@@ -136,9 +608,16 @@ bool DynamicBandpassFilter::initialize(int sample_rate, int fft_size) {
         passband_low_hz_.store(-half_bandwidth);
         passband_high_hz_.store(half_bandwidth);
         current_center_freq_.store(config_.center_frequency);
+        pending_center_changes_.store(0);
         ssb_carrier_offset_.store(defaults.carrier_offset);
         ssb_sharp_cutoff_.store(defaults.sharp_cutoff);
         
+        // Reset adaptive centering state (history is released by cleanup())
+        energy_history_.assign(32, 0.0f);
+        energy_history_idx_ = 0;
+        afc_offset_hz_.store(0.0f);
+        afc_smoothed_error_ = 0.0f;
+        
         // Design initial filter
         designFilter();
         
@@ -149,14 +628,27 @@ bool DynamicBandpassFilter::initialize(int sample_rate, int fft_size) {
             current_stats_.is_enabled = enabled_.load();
             current_stats_.ssb_mode_active = (config_.protocol == USB || config_.protocol == LSB);
             current_stats_.ssb_carrier_offset_hz = defaults.carrier_offset;
+            current_stats_.stopband_attenuation_db = config_.stopband_attenuation;
+            current_stats_.minimum_phase_active = config_.minimum_phase;
+            current_stats_.fft_backend = fft_backend_->name();
+            current_stats_.fft_backend_us = backend_selection.microseconds;
+            publishStatsLocked();
         }
         
+        // designFilter() above is a no-op until initialized and enabled, so the real
+        // kernel is designed on the first process() call
         initialized_.store(true);
-        parameters_changed_.store(false);
+        parameters_changed_.store(true);
+        
+        required_kernel_length_.store(selectFFTSize(processing_rate, config_.bandwidth, defaults.transition_width,
+                                                    config_.stopband_attenuation, 0.0).kernel_length);
         
         qDebug() << "DynamicBandpassFilter: Initialized successfully";
         qDebug() << "  Sample rate:" << config_.sample_rate << "Hz";
-        qDebug() << "  FFT size:" << fft_size;
+        if (decimation > 1) {
+            qDebug() << "  Pre-decimation:" << decimation << "->" << processing_rate << "Hz";
+        }
+        qDebug() << "  FFT size:" << fft_size << "- backend:" << fft_backend_->name();
         qDebug() << "  Frequency resolution:" << frequency_resolution_.load() << "Hz";
         
         return true;
@@ -168,10 +660,183 @@ bool DynamicBandpassFilter::initialize(int sample_rate, int fft_size) {
     }
 }
 
+bool DynamicBandpassFilter::initializeAuto(int sample_rate, double latency_budget_ms) {
+    if (sample_rate <= 0) return false;
+    
+    // The kernel is designed against the same budget
+    auto_fft_latency_ms_.store(std::max(latency_budget_ms, 0.0));
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        config_.sample_rate = sample_rate;
+    }
+    
+    FFTSizeSelection selection = selectFFTSizeForConfig(latency_budget_ms);
+    qDebug() << "DynamicBandpassFilter: Auto FFT size" << selection.fft_size
+             << "- kernel length:" << selection.kernel_length
+             << "block:" << selection.block_size
+             << "latency:" << selection.latency_ms << "ms";
+    if (!selection.meets_latency) {
+        qDebug() << "  Warning: kernel shortened to the" << latency_budget_ms << "ms latency budget - wider transition";
+    }
+    
+    if (!initialize(sample_rate, selection.fft_size)) {
+        return false;
+    }
+    
+    return true;
+}
+
+void DynamicBandpassFilter::setAutoFFTSize(bool enabled, double latency_budget_ms) {
+    auto_fft_latency_ms_.store(std::max(latency_budget_ms, 0.0));
+    auto_fft_size_.store(enabled);
+    parameters_changed_.store(true);   // Kernel length follows the budget
+    
+    qDebug() << "DynamicBandpassFilter: Auto FFT size" << (enabled ? "enabled" : "disabled")
+             << "- latency budget:" << latency_budget_ms << "ms";
+    
+    if (enabled) {
+        applyAutoFFTSize();
+    }
+}
+
+DynamicBandpassFilter::FFTSizeSelection DynamicBandpassFilter::selectFFTSize(double sample_rate, double bandwidth_hz,
+                                                                             double transition_fraction,
+                                                                             double stopband_atten_db,
+                                                                             double latency_budget_ms) {
+    FFTSizeSelection selection = {MIN_AUTO_FFT_SIZE, MIN_AUTO_FFT_SIZE, 1, 0.0, true};
+    if (sample_rate <= 0.0) {
+        return selection;
+    }
+    
+    // Kaiser estimate for the window the kernel design actually uses
+    double transition_hz = std::max(bandwidth_hz * transition_fraction, 1.0);
+    double atten = std::max(stopband_atten_db + KERNEL_DESIGN_MARGIN_DB, 21.0);
+    int kernel_length = KaiserWindow::estimateLength(atten, transition_hz / sample_rate);
+    kernel_length = std::clamp(kernel_length, 1, MAX_AUTO_FFT_SIZE / 2 - 1) | 1;
+    
+    // Short blocks are filtered as they arrive, so the kernel's group delay is the only
+    // latency; a budget caps the kernel length and widens the transition instead
+    if (latency_budget_ms > 0.0) {
+        int budget_length = 2 * static_cast<int>(latency_budget_ms * sample_rate / 1000.0) + 1;
+        if (kernel_length > budget_length) {
+            kernel_length = budget_length;
+            selection.meets_latency = false;
+        }
+    }
+    selection.kernel_length = kernel_length;
+    
+    // Overlap-save cost per output sample: two FFTs plus the kernel multiply per hop
+    double best_cost = 0.0;
+    for (int n = MIN_AUTO_FFT_SIZE; n <= MAX_AUTO_FFT_SIZE; n *= 2) {
+        if (n < 2 * kernel_length) continue;
+        // Past about eight kernels the saving is a few percent, while a short call still
+        // pays for a whole frame
+        if (best_cost > 0.0 && n > 8 * kernel_length) break;
+        
+        int hop = n - kernel_length + 1;
+        double cost = (2.0 * n * std::log2(static_cast<double>(n)) + n) / hop;
+        if (best_cost == 0.0 || cost < best_cost) {
+            best_cost = cost;
+            selection.fft_size = n;
+        }
+    }
+    
+    selection.block_size = selection.fft_size - kernel_length + 1;
+    selection.latency_ms = 1000.0 * (kernel_length - 1) / 2.0 / sample_rate;
+    return selection;
+}
+
+DynamicBandpassFilter::FFTSizeSelection DynamicBandpassFilter::selectFFTSizeForConfig(double latency_budget_ms) {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(config_.protocol)];
+    double processing_rate = config_.sample_rate / computePreDecimation(config_);
+    return selectFFTSize(processing_rate, config_.bandwidth, defaults.transition_width,
+                         config_.stopband_attenuation, latency_budget_ms);
+}
+
+void DynamicBandpassFilter::applyAutoFFTSize() {
+    // Must be called without config_mutex_ held - initialize() takes it
+    if (!auto_fft_size_.load() || !initialized_.load()) return;
+    
+    FFTSizeSelection selection = selectFFTSizeForConfig(auto_fft_latency_ms_.load());
+    required_kernel_length_.store(selection.kernel_length);
+    if (selection.fft_size == fft_size_.load()) return;
+    
+    int sample_rate;
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        sample_rate = static_cast<int>(config_.sample_rate);
+    }
+    
+    qDebug() << "DynamicBandpassFilter: Resizing FFT" << fft_size_.load() << "->" << selection.fft_size;
+    reconfigure(sample_rate, selection.fft_size);
+}
+
+void DynamicBandpassFilter::setPreDecimation(bool enabled) {
+    pre_decimation_enabled_.store(enabled);
+    parameters_changed_.store(true);  // Front end and kernel follow on the next process() call
+    
+    qDebug() << "DynamicBandpassFilter: Pre-decimation" << (enabled ? "enabled" : "disabled");
+    
+    applyAutoFFTSize();
+}
+
+double DynamicBandpassFilter::getOutputSampleRate() const {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    return config_.sample_rate / pre_decimation_.load();
+}
+
+int DynamicBandpassFilter::computePreDecimation(const FilterConfig& config) const {
+    return computePreDecimation(config, current_center_freq_.load(), ssb_carrier_offset_.load(),
+                                passband_low_hz_.load(), passband_high_hz_.load());
+}
+
+int DynamicBandpassFilter::computePreDecimation(const FilterConfig& config, float center, float carrier_offset,
+                                                float low, float high) const {
+    if (!pre_decimation_enabled_.load() || config.sample_rate <= 0.0) {
+        return 1;
+    }
+    
+    // Highest frequency the bandpass must still see, including transition and AFC range
+    const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(config.protocol)];
+    if (config.protocol == USB || config.protocol == LSB) {
+        center += carrier_offset;
+    }
+    float transition = (high - low) * defaults.transition_width;
+    float afc_range = afc_enabled_.load() ? afc_max_offset_hz_.load() : 0.0f;
+    float max_frequency = std::max(std::abs(center + low), std::abs(center + high)) + transition + afc_range;
+    if (scan_enabled_.load()) {
+        max_frequency = std::max(max_frequency, scan_max_frequency_hz_.load());
+    }
+    
+    return MultistageDecimator::chooseDecimation(config.sample_rate, max_frequency);
+}
+
+void DynamicBandpassFilter::updatePreDecimation() {
+    int decimation;
+    double sample_rate;
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        decimation = computePreDecimation(config_);
+        sample_rate = config_.sample_rate;
+    }
+    
+    if (decimation == pre_decimation_.load()) return;
+    
+    {
+        std::lock_guard<std::mutex> decimator_lock(decimator_mutex_);
+        pre_decimator_.configure(decimation);
+    }
+    pre_decimation_.store(decimation);
+    frequency_resolution_.store(static_cast<float>(sample_rate / decimation / fft_size_.load()));
+    
+    qDebug() << "DynamicBandpassFilter: Pre-decimation" << decimation << "->" << (sample_rate / decimation) << "Hz";
+}
+
 void DynamicBandpassFilter::configure(const FilterConfig& config) {
     if (!initialized_.load()) return;
     
-    std::lock_guard<std::mutex> lock(config_mutex_);
+    std::unique_lock<std::mutex> lock(config_mutex_);
     config_ = config;
     
     // Update SSB parameters
@@ -179,6 +844,9 @@ void DynamicBandpassFilter::configure(const FilterConfig& config) {
     ssb_sharp_cutoff_.store(config.ssb_sharp_cutoff);
     
     parameters_changed_.store(true);
+    lock.unlock();
+    
+    applyAutoFFTSize();
     
     qDebug() << "DynamicBandpassFilter: Configuration updated (will apply on next process)";
 }
@@ -186,8 +854,11 @@ void DynamicBandpassFilter::configure(const FilterConfig& config) {
 void DynamicBandpassFilter::setEnabled(bool enabled) {
     enabled_.store(enabled);
     
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    current_stats_.is_enabled = enabled;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        current_stats_.is_enabled = enabled;
+        publishStatsLocked();
+    }
     
     qDebug() << "DynamicBandpassFilter:" << (enabled ? "Enabled" : "Disabled");
 }
@@ -202,173 +873,415 @@ bool DynamicBandpassFilter::isValidForProcessing() const {
 void DynamicBandpassFilter::safelyUpdateKernel() {
     if (!isValidForProcessing()) return;
     
+    // Snapshot before filter_mutex_: initialize() holds config_mutex_ while it takes filter_mutex_
+    FilterConfig config_copy;
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        config_copy = config_;
+    }
+    
     std::lock_guard<std::mutex> filter_lock(filter_mutex_);
     
+    // A fresh design always supersedes a kernel loaded from file
+    mapped_kernel_.reset();
+    
     int fft_size = fft_size_.load();
     if (filter_kernel_.size() != static_cast<size_t>(fft_size)) {
         filter_kernel_.resize(fft_size, std::complex<float>(1.0f, 0.0f));
     }
     
+    KernelDesignRecord record = designKernelInto(filter_kernel_, fft_size, frequency_resolution_.load(),
+                                                 config_copy, true, pre_decimation_.load(), design_scratch_);
+    kernel_length_ = record.kernel_length;
+    updateKernelBandsLocked();
+    kernel_designed_ = true;
+    designed_protocol_ = record.protocol;
+    designed_low_hz_ = record.low_hz;
+    designed_high_hz_ = record.high_hz;
+    designed_carrier_hz_ = record.carrier_hz;
+    group_delay_samples_.store(record.group_delay_samples);
+}
+
+DynamicBandpassFilter::KernelDesignRecord DynamicBandpassFilter::designKernelInto(
+    std::vector<std::complex<float>>& kernel, int fft_size, float freq_res, const FilterConfig& config,
+    bool apply_notches, int decimation, KernelDesignScratch& scratch) {
+    // kernel must already hold fft_size bins. Reads the passband atomics, so it can run
+    // on any thread; notch bins refer to the current fft_size and need filter_mutex_.
     float low_cutoff = passband_low_hz_.load() + current_center_freq_.load();
     float high_cutoff = passband_high_hz_.load() + current_center_freq_.load();
-    float freq_res = frequency_resolution_.load();
     float carrier_offset = ssb_carrier_offset_.load();
     
-    FilterConfig config_copy;
-    {
-        std::lock_guard<std::mutex> config_lock(config_mutex_);
-        config_copy = config_;
-    }
-    
     // Apply carrier offset for SSB modes
-    if (config_copy.protocol == USB || config_copy.protocol == LSB) {
+    bool ssb_mode = (config.protocol == USB || config.protocol == LSB);
+    float carrier_freq = current_center_freq_.load();
+    if (ssb_mode) {
         low_cutoff += carrier_offset;
         high_cutoff += carrier_offset;
+        
+        // One-sided passband: never extend past the suppressed carrier
+        if (config.protocol == USB) {
+            low_cutoff = std::max(low_cutoff, carrier_freq);
+        } else {
+            high_cutoff = std::min(high_cutoff, carrier_freq);
+        }
     }
     
-    for (int i = 0; i < fft_size; ++i) {
-        // Convert FFT bin to frequency
-        float freq;
-        if (i <= fft_size / 2) {
-            freq = i * freq_res;
-        } else {
-            freq = (i - fft_size) * freq_res;
+    // Design parameters, stopband floor under the configured attenuation
+    const float design_atten_db = static_cast<float>(config.stopband_attenuation + KERNEL_DESIGN_MARGIN_DB);
+    KernelDesignParams params;
+    params.low_cutoff = low_cutoff;
+    params.high_cutoff = high_cutoff;
+    params.carrier_freq = carrier_freq;
+    params.freq_res = freq_res;
+    params.min_response = std::pow(10.0f, -design_atten_db / 20.0f);
+    
+    // Dispatch once per design to the instantiation for this protocol and cutoff style
+    KernelDesignFn design = selectKernelDesign(config.protocol, ssb_sharp_cutoff_.load());
+    design(kernel.data(), fft_size, params);
+    
+    int kernel_length = designKernelLength(config, static_cast<double>(freq_res) * fft_size, fft_size);
+    
+    // Birdie notches are part of the kernel, so they cost nothing per sample. An FIR of
+    // kernel_length taps resolves about fft_size / kernel_length bins, so narrower notches
+    // would be filled in by the windowing below.
+    if (apply_notches) {
+        int half_width = (fft_size + kernel_length - 1) / kernel_length;
+        applyNotchBank(kernel.data(), fft_size, params.min_response, half_width);
+    }
+    
+    // Undo the pre-decimation front end's droop across the passband (up to +6 dB); stopband
+    // bins are left alone so the kernel's own attenuation is unchanged
+    if (decimation > 1) {
+        int half = fft_size / 2;
+        scratch.front_end_gain.resize(half + 1);
+        MultistageDecimator::passbandMagnitude(decimation, static_cast<double>(freq_res) * fft_size, freq_res,
+                                               half + 1, scratch.front_end_gain.data());
+        for (int i = 0; i < fft_size; ++i) {
+            if (std::abs(kernel[i]) < 0.5f) continue;
+            float gain = scratch.front_end_gain[i <= half ? i : fft_size - i];
+            kernel[i] /= std::max(gain, 0.5f);
         }
+    }
+    
+    // Frequency-sampled response -> causal FIR the overlap-save loop can apply exactly
+    if (!windowKernel(kernel, kernel_length, design_atten_db, scratch)) {
+        qDebug() << "DynamicBandpassFilter: Kernel windowing failed, using an all-pass kernel";
+        std::fill(kernel.begin(), kernel.end(), std::complex<float>(1.0f, 0.0f));
+        kernel_length = 1;
+    }
+    
+    // Optional minimum-phase version of the same magnitude response
+    if (config.minimum_phase && !makeMinimumPhase(kernel, kernel_length, scratch)) {
+        qDebug() << "DynamicBandpassFilter: Minimum-phase conversion failed, keeping linear-phase kernel";
+    }
+    
+    KernelDesignRecord record;
+    record.protocol = config.protocol;
+    record.low_hz = low_cutoff;
+    record.high_hz = high_cutoff;
+    record.carrier_hz = carrier_freq;
+    record.min_response = params.min_response;
+    record.group_delay_samples = measureGroupDelay(kernel);
+    record.kernel_length = kernel_length;
+    return record;
+}
+
+int DynamicBandpassFilter::designKernelLength(const FilterConfig& config, double processing_rate, int fft_size) const {
+    // Spec length at the processing rate, within the latency budget; overlap-save keeps at
+    // least half of every FFT frame for new samples
+    const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(config.protocol)];
+    int spec_length = selectFFTSize(processing_rate, config.bandwidth, defaults.transition_width,
+                                    config.stopband_attenuation, auto_fft_latency_ms_.load()).kernel_length;
+    return std::clamp(spec_length, 1, std::max(fft_size / 2 - 1, 1));
+}
+
+bool DynamicBandpassFilter::windowKernel(std::vector<std::complex<float>>& kernel, int kernel_length,
+                                         float stopband_atten_db, KernelDesignScratch& scratch) {
+    // The zero-phase impulse response of the sampled design is centred on tap 0 and wraps
+    // around the FFT. Rotate its centre to tap (L - 1) / 2 and Kaiser-window it to L taps:
+    // a causal linear-phase FIR, so kernel_length - 1 samples of history make the block
+    // convolution linear rather than circular.
+    int n = static_cast<int>(kernel.size());
+    if (kernel_length < 1 || kernel_length > n || !scratch.prepare(n)) return false;
+    
+    fftwf_complex* buffer = scratch.buffer;
+    for (int i = 0; i < n; ++i) {
+        buffer[i][0] = kernel[i].real();
+        buffer[i][1] = kernel[i].imag();
+    }
+    scratch.backend->inverse(buffer, buffer);
+    
+    float beta = static_cast<float>(KaiserWindow::beta(stopband_atten_db));
+    if (scratch.window.size() != static_cast<size_t>(kernel_length) || scratch.window_beta != beta) {
+        scratch.window.resize(kernel_length);
+        KaiserWindow::fill(scratch.window.data(), kernel_length, beta);
+        scratch.window_beta = beta;
+    }
+    
+    int centre = (kernel_length - 1) / 2;
+    float norm = 1.0f / n;
+    scratch.taps.resize(kernel_length);
+    for (int t = 0; t < kernel_length; ++t) {
+        int source = (t - centre + n) % n;
+        scratch.taps[t] = std::complex<float>(buffer[source][0], buffer[source][1]) * (scratch.window[t] * norm);
+    }
+    
+    memset(buffer, 0, sizeof(fftwf_complex) * n);
+    for (int t = 0; t < kernel_length; ++t) {
+        buffer[t][0] = scratch.taps[t].real();
+        buffer[t][1] = scratch.taps[t].imag();
+    }
+    scratch.backend->forward(buffer, buffer);
+    for (int i = 0; i < n; ++i) {
+        kernel[i] = std::complex<float>(buffer[i][0], buffer[i][1]);
+    }
+    return true;
+}
+
+bool DynamicBandpassFilter::makeMinimumPhase(std::vector<std::complex<float>>& kernel, int kernel_length,
+                                             KernelDesignScratch& scratch) {
+    // Homomorphic (cepstral) method: fold the real cepstrum of log|H| onto positive
+    // quefrencies and exponentiate. Its impulse response starts at tap 0 with most of the
+    // energy early, so it is cut back to kernel_length taps with a short taper and fits the
+    // same overlap-save history as the linear-phase kernel it came from.
+    int n = static_cast<int>(kernel.size());
+    if (n < 4 || kernel_length < 1 || kernel_length > n || !scratch.prepare(n)) return false;
+    
+    fftwf_complex* buffer = scratch.buffer;
+    for (int i = 0; i < n; ++i) {
+        buffer[i][0] = std::log(std::max(std::abs(kernel[i]), 1e-10f));
+        buffer[i][1] = 0.0f;
+    }
+    scratch.backend->inverse(buffer, buffer);
+    
+    // Causal folding window: c[0], 2c[1..n/2-1], c[n/2], zeros. The cepstrum is
+    // complex for one-sided (SSB) kernels, so both parts are kept.
+    float norm = 1.0f / n;
+    for (int i = 0; i < n; ++i) {
+        float w = (i == 0 || i == n / 2) ? 1.0f : (i < n / 2 ? 2.0f : 0.0f);
+        buffer[i][0] *= w * norm;
+        buffer[i][1] *= w * norm;
+    }
+    scratch.backend->forward(buffer, buffer);
+    
+    for (int i = 0; i < n; ++i) {
+        std::complex<float> h = std::exp(std::complex<float>(buffer[i][0], buffer[i][1]));
+        buffer[i][0] = h.real();
+        buffer[i][1] = h.imag();
+    }
+    
+    // Back to taps, cut to kernel_length with a raised cosine over the last eighth
+    scratch.backend->inverse(buffer, buffer);
+    int taper = std::max(kernel_length / 8, 1);
+    for (int t = 0; t < n; ++t) {
+        float w = 0.0f;
+        if (t < kernel_length - taper) {
+            w = 1.0f;
+        } else if (t < kernel_length) {
+            w = 0.5f + 0.5f * std::cos(static_cast<float>(M_PI) * (t - (kernel_length - taper) + 1) / (taper + 1));
+        }
+        buffer[t][0] *= w * norm;
+        buffer[t][1] *= w * norm;
+    }
+    scratch.backend->forward(buffer, buffer);
+    
+    for (int i = 0; i < n; ++i) {
+        kernel[i] = std::complex<float>(buffer[i][0], buffer[i][1]);
+    }
+    return true;
+}
+
+float DynamicBandpassFilter::measureGroupDelay(const std::vector<std::complex<float>>& kernel) const {
+    // Power-weighted mean of -d(phase)/d(omega) across the passband, in samples
+    int n = static_cast<int>(kernel.size());
+    if (n < 2) return 0.0f;
+    
+    double weighted_delay = 0.0;
+    double weight_sum = 0.0;
+    float bin_omega = 2.0f * static_cast<float>(M_PI) / n;
+    for (int i = 0; i < n; ++i) {
+        const std::complex<float>& h0 = kernel[i];
+        const std::complex<float>& h1 = kernel[(i + 1) % n];
+        float weight = std::min(std::norm(h0), std::norm(h1));
+        if (weight < 0.5f) continue;  // Passband bins only
         
-        float response = 0.0f;
-        
-        // SSB-specific filter shaping
-        if (config_copy.protocol == USB || config_copy.protocol == LSB) {
-            if (ssb_sharp_cutoff_.load()) {
-                // Sharp cutoff for SSB with steeper transition
-                float transition = freq_res * 1.0f;  // Narrower transition for SSB
-                
-                if (freq >= low_cutoff && freq <= high_cutoff) {
-                    response = 1.0f;
-                } else if (freq >= low_cutoff - transition && freq < low_cutoff) {
-                    // Steeper transition
-                    float t = (freq - (low_cutoff - transition)) / transition;
-                    response = t * t * (3.0f - 2.0f * t);  // Smooth step function
-                } else if (freq > high_cutoff && freq <= high_cutoff + transition) {
-                    float t = ((high_cutoff + transition) - freq) / transition;
-                    response = t * t * (3.0f - 2.0f * t);  // Smooth step function
-                }
-                
-                // Additional suppression of opposite sideband for SSB
-                if (config_copy.protocol == USB && freq < current_center_freq_.load()) {
-                    response *= 0.01f;  // Strong suppression of LSB for USB
-                } else if (config_copy.protocol == LSB && freq > current_center_freq_.load()) {
-                    response *= 0.01f;  // Strong suppression of USB for LSB
-                }
-            } else {
-                // Standard rectangular filter
-                if (freq >= low_cutoff && freq <= high_cutoff) {
-                    response = 1.0f;
-                }
-            }
-        } else {
-            // Standard filter for non-SSB modes
-            if (freq >= low_cutoff && freq <= high_cutoff) {
-                response = 1.0f;
-            } else {
-                // Add transition zone
-                float transition = freq_res * 2.0f;
-                if (freq >= low_cutoff - transition && freq < low_cutoff) {
-                    response = (freq - (low_cutoff - transition)) / transition;
-                } else if (freq > high_cutoff && freq <= high_cutoff + transition) {
-                    response = ((high_cutoff + transition) - freq) / transition;
-                }
-            }
-        }
-        
-        // Apply stopband attenuation
-        float min_response = std::pow(10.0f, -static_cast<float>(config_copy.stopband_attenuation) / 20.0f);
-        response = std::max(response, min_response);
-        
-        filter_kernel_[i] = std::complex<float>(response, 0.0f);
+        float phase_step = std::arg(h1 * std::conj(h0));
+        weighted_delay += weight * (-phase_step / bin_omega);
+        weight_sum += weight;
     }
+    
+    return weight_sum > 0.0 ? static_cast<float>(weighted_delay / weight_sum) : 0.0f;
 }
 
 std::vector<std::complex<float>> DynamicBandpassFilter::process(const std::vector<std::complex<float>>& input) {
-    if (!isValidForProcessing() || input.empty()) {
-        return input;  // Bypass if not ready
+    if (input.empty()) {
+        return input;
     }
     
-    // Set processing flag
-    processing_active_.store(true);
+    // Output never exceeds the input length (pre-decimation only shortens it)
+    std::vector<std::complex<float>> output(input.size());
+    size_t written = 0;
+    if (init_state_.load() == INITIALIZING) {
+        written = outputWhileInitializing(input.data(), input.size(), output.data());
+    } else if (!isValidForProcessing()) {
+        written = passThrough(input.data(), input.size(), output.data(), output.size(), false);  // Bypass if not ready
+    } else {
+        written = filterInto(input.data(), input.size(), output.data(), output.size());
+    }
+    output.resize(written);
+    return output;
+}
+
+SampleBlockPool::Block DynamicBandpassFilter::process(const std::complex<float>* input, size_t count, SampleBlockPool& pool) {
+    // Runs once per block, so drops are counted in FilterStats rather than logged
+    SampleBlockPool::Block block = pool.acquire();
+    if (!block) {
+        pool_exhausted_drops_.fetch_add(1);
+        return block;
+    }
     
-    // Ensure we clear the flag when done
-    struct ProcessingGuard {
-        std::atomic<bool>& flag;
-        ProcessingGuard(std::atomic<bool>& f) : flag(f) {}
-        ~ProcessingGuard() { flag.store(false); }
-    } guard(processing_active_);
+    // Worst case is a bypass, which returns the input unchanged
+    if (!input || count > block.capacity()) {
+        oversized_input_drops_.fetch_add(1);
+        return SampleBlockPool::Block();
+    }
     
-    // Simple bypass for very large inputs to prevent memory issues
-    int current_fft_size = fft_size_.load();
-    if (input.size() > static_cast<size_t>(current_fft_size) * 10) {
-        qDebug() << "DynamicBandpassFilter: Input too large, bypassing";
-        return input;
+    if (init_state_.load() == INITIALIZING) {
+        block.resize(outputWhileInitializing(input, count, block.data()));
+        return block;
+    }
+    if (!isValidForProcessing()) {
+        block.resize(passThrough(input, count, block.data(), block.capacity(), false));
+        return block;
+    }
+    
+    block.resize(filterInto(input, count, block.data(), block.capacity()));
+    return block;
+}
+
+size_t DynamicBandpassFilter::processCU8(const uint8_t* buffer, size_t bytes,
+                                        std::complex<float>* output, size_t capacity) {
+    static const struct CU8Table {
+        float value[256];
+        CU8Table() {
+            for (int i = 0; i < 256; ++i) value[i] = cu8ToFloat(i);
+        }
+    } table;
+    
+    // Runs once per driver callback, so rejections are returned, not logged; the caller
+    // counts them (RtlSdrIngest's dropped_buffers)
+    size_t count = bytes / 2;
+    if (!buffer || !output || count == 0 || count > capacity) return 0;
+    
+    // The only pass over the driver buffer - everything after this works on output
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = std::complex<float>(table.value[buffer[2 * i]], table.value[buffer[2 * i + 1]]);
+    }
+    
+    if (init_state_.load() == INITIALIZING) {
+        return outputWhileInitializing(output, count, output);
+    }
+    if (!isValidForProcessing()) {
+        return passThrough(output, count, output, capacity, false);
+    }
+    return filterInto(output, count, output, capacity);
+}
+
+SampleBlockPool::Block DynamicBandpassFilter::processCU8(const uint8_t* buffer, size_t bytes, SampleBlockPool& pool) {
+    SampleBlockPool::Block block = pool.acquire();
+    if (!block) {
+        pool_exhausted_drops_.fetch_add(1);
+        return block;
+    }
+    if (bytes / 2 > block.capacity()) {
+        oversized_input_drops_.fetch_add(1);
+        return SampleBlockPool::Block();
     }
     
-    // Update filter if parameters changed
+    size_t written = processCU8(buffer, bytes, block.data(), block.capacity());
+    if (written == 0) {
+        return SampleBlockPool::Block();
+    }
+    block.resize(written);
+    return block;
+}
+
+size_t DynamicBandpassFilter::filterInto(const std::complex<float>* input, size_t count,
+                                         std::complex<float>* output, size_t capacity) {
+    // Shared core of both process() overloads. On bypass the input only goes through the
+    // pre-decimation front end; capacity must be at least count.
+    // input may alias output (processCU8 converts in place first)
+    auto bypass = [&]() {
+        return passThrough(input, count, output, capacity, false);
+    };
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    // Resources a reconfiguration replaced. Declared before the gate scope, so they are freed
+    // once this call has left the gate and dropped its locks, never while a block runs
+    std::unique_ptr<PendingReconfiguration> retired;
+    
+    // Counted in flight so initialize() and the destructor can wait for exactly this call
+    QuiescenceGate::ActiveScope active(processing_gate_);
+    if (!active) {
+        // Engine is being rebuilt or torn down
+        return init_state_.load() == INITIALIZING ? outputWhileInitializing(input, std::min(count, capacity), output)
+                                                   : bypass();
+    }
+    
+    // Re-checked once counted: initialization may have started since the caller looked
+    if (init_state_.load() == INITIALIZING) {
+        return outputWhileInitializing(input, std::min(count, capacity), output);
+    }
+    
+    // Block boundary: pick up a configuration staged by reconfigure()
+    if (reconfigure_pending_.load()) {
+        retired = applyPendingReconfiguration();
+    }
+    
+    // Block boundary: pick up a center frequency or AFC change staged by the setters, ahead
+    // of the parameter update that redesigns the kernel for it
+    if (pending_center_changes_.load(std::memory_order_acquire) != 0) {
+        applyPendingCenterChanges();
+    }
+    
+    // Update filter if parameters changed; the full update covers a pending retune too
     if (parameters_changed_.load()) {
+        kernel_retune_pending_.store(false);
         updateFilterParameters();
+    } else if (kernel_retune_pending_.exchange(false)) {
+        // AFC or notch tracking moved the kernel: redesign it without the full update or its logging
+        safelyUpdateKernel();
+        publishDesignStats();
+    }
+    
+    // No length limit: the block loop works in place one hop at a time, so a driver-sized
+    // buffer costs no more memory than a single block
+    
+    // Snapshot the protocol once per call for adaptive centering and notch tracking
+    Protocol block_protocol = WFM;
+    if (afc_enabled_.load() || auto_notch_enabled_.load()) {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        block_protocol = config_.protocol;
     }
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
+    // Once the front end has run, input may be gone (aliasing) and the decimator has
+    // advanced, so failures after that return its output unfiltered
+    size_t samples = 0;
+    bool front_end_done = false;
     try {
-        std::vector<std::complex<float>> output;
-        output.reserve(input.size());
+        // Bring the rate down before the FFT bandpass when the front end is active,
+        // writing straight into the output, which is then filtered in place
+        samples = runFrontEnd(input, count, output, capacity);
+        front_end_done = true;
         
-        size_t pos = 0;
-        while (pos < input.size() && isValidForProcessing()) {
-            size_t block_size = std::min(static_cast<size_t>(current_fft_size), input.size() - pos);
-            
-            // Process block with proper locking
-            {
-                std::lock_guard<std::mutex> fft_lock(fft_mutex_);
-                
-                if (!fft_input_ || !fft_output_ || !forward_plan_ || !inverse_plan_) {
-                    qDebug() << "DynamicBandpassFilter: FFT resources not available";
-                    break;
-                }
-                
-                // Clear and fill FFT input
-                memset(fft_input_, 0, sizeof(fftwf_complex) * current_fft_size);
-                for (size_t i = 0; i < block_size; ++i) {
-                    fft_input_[i][0] = input[pos + i].real();
-                    fft_input_[i][1] = input[pos + i].imag();
-                }
-                
-                // Forward FFT
-                fftwf_execute(forward_plan_);
-                
-                // Apply filter
-                {
-                    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
-                    if (filter_kernel_.size() == static_cast<size_t>(current_fft_size)) {
-                        for (int i = 0; i < current_fft_size; ++i) {
-                            std::complex<float> sample(fft_output_[i][0], fft_output_[i][1]);
-                            std::complex<float> filtered = sample * filter_kernel_[i];
-                            fft_output_[i][0] = filtered.real();
-                            fft_output_[i][1] = filtered.imag();
-                        }
-                    }
-                }
-                
-                // Inverse FFT
-                fftwf_execute(inverse_plan_);
-                
-                // Extract results with normalization
-                float norm = 1.0f / current_fft_size;
-                for (size_t i = 0; i < block_size; ++i) {
-                    output.emplace_back(fft_input_[i][0] * norm, fft_input_[i][1] * norm);
-                }
-            }
-            
-            pos += block_size;
+        if (!filterBlocksInPlace(output, samples, block_protocol)) {
+            total_samples_bypassed_.fetch_add(count);
+            return samples;
         }
         
         // Update statistics
@@ -378,23 +1291,207 @@ std::vector<std::complex<float>> DynamicBandpassFilter::process(const std::vecto
         {
             std::lock_guard<std::mutex> lock(stats_mutex_);
             current_stats_.processing_time_ms = duration.count() / 1000.0f;
-            current_stats_.samples_processed = input.size();
-            total_samples_processed_.fetch_add(input.size());
+            current_stats_.samples_processed = count;
+            total_samples_processed_.fetch_add(count);
+            publishStatsLocked();
         }
         
-        return output;
+        return samples;
         
     } catch (const std::exception& e) {
         qDebug() << "DynamicBandpassFilter: Processing exception:" << e.what();
-        return input;
+        if (!front_end_done) return bypass();
+        total_samples_bypassed_.fetch_add(count);
+        return samples;
     } catch (...) {
         qDebug() << "DynamicBandpassFilter: Unknown processing exception";
-        return input;
+        if (!front_end_done) return bypass();
+        total_samples_bypassed_.fetch_add(count);
+        return samples;
+    }
+}
+
+bool DynamicBandpassFilter::filterBlocksInPlace(std::complex<float>* samples, size_t count, Protocol block_protocol) {
+    int current_fft_size = fft_size_.load();
+    
+    // Per-call snapshot of the optional per-block features
+    const bool full_blocks_only_features = afc_enabled_.load() || auto_notch_enabled_.load() ||
+                                           spectrum_tap_enabled_.load() || scan_enabled_.load();
+    const bool track_afc = afc_enabled_.load();
+    const bool track_notches = auto_notch_enabled_.load();
+    const bool feed_spectrum_tap = spectrum_tap_enabled_.load();
+    const bool scan_band = scan_enabled_.load();
+    const float norm = 1.0f / current_fft_size;
+    
+    // Locks are taken once per call rather than once per block
+    std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+    
+    if (!fft_input_ || !fft_output_ || !fft_backend_) {
+        qDebug() << "DynamicBandpassFilter: FFT resources not available";
+        return false;
+    }
+    
+    // Pick the block kernel once; the inner loop carries no feature branches
+    int kernel_size = 0;
+    const std::complex<float>* kernel = activeKernelLocked(kernel_size);
+    const bool kernel_ready = kernel_size == current_fft_size &&
+                              kernel_bands_.power.size() == static_cast<size_t>(current_fft_size);
+    const bool apply_nr = noise_reducer_ && nr_gains_.size() == static_cast<size_t>(current_fft_size) &&
+                          nr_smoothed_gains_.size() == nr_gains_.size() && nr_window_.size() == nr_gains_.size();
+    const BlockKernelFn apply_kernel = apply_nr ? &applyKernelToBlock<true> : &applyKernelToBlock<false>;
+    
+    // Overlap-save: each frame is the last kernel_length - 1 input samples followed by up to
+    // hop new ones. Outputs before the overlap are circular wraparound and are discarded; the
+    // rest are the exact linear convolution, so a short final frame needs no extra latency.
+    const size_t overlap = kernel_ready ? static_cast<size_t>(std::max(activeKernelLengthLocked(), 1) - 1) : 0;
+    const size_t hop = static_cast<size_t>(current_fft_size) - overlap;
+    if (overlap_history_.size() != overlap) {
+        // Kernel length changed: keep the newest samples, zeros before them
+        if (overlap_history_.size() > overlap) {
+            overlap_history_.erase(overlap_history_.begin(), overlap_history_.end() - overlap);
+        } else {
+            overlap_history_.insert(overlap_history_.begin(), overlap - overlap_history_.size(),
+                                    std::complex<float>(0.0f, 0.0f));
+        }
+    }
+    
+    size_t pos = 0;
+    while (pos < count) {
+        size_t block_size = std::min(hop, count - pos);
+        bool full_block = block_size == hop;
+        
+        // History, new samples, zero padding
+        for (size_t i = 0; i < overlap; ++i) {
+            fft_input_[i][0] = overlap_history_[i].real();
+            fft_input_[i][1] = overlap_history_[i].imag();
+        }
+        for (size_t i = 0; i < block_size; ++i) {
+            fft_input_[overlap + i][0] = samples[pos + i].real();
+            fft_input_[overlap + i][1] = samples[pos + i].imag();
+        }
+        size_t filled = overlap + block_size;
+        memset(fft_input_ + filled, 0, sizeof(fftwf_complex) * (current_fft_size - filled));
+        
+        // The newest overlap samples seed the next frame; saved before the inverse FFT reuses the buffer
+        for (size_t i = 0; i < overlap; ++i) {
+            overlap_history_[i] = std::complex<float>(fft_input_[block_size + i][0], fft_input_[block_size + i][1]);
+        }
+        
+        // Forward FFT
+        fft_backend_->forward(fft_input_, fft_output_);
+        
+        // Analysis on the spectrum we already have (full frames only)
+        if (full_blocks_only_features && full_block) {
+            if (track_afc) {
+                updateAdaptiveCentering(fft_output_, current_fft_size, static_cast<int>(hop), block_protocol);
+            }
+            if (track_notches) {
+                updateNotchBank(fft_output_, current_fft_size, static_cast<int>(hop), block_protocol);
+            }
+            if (feed_spectrum_tap) {
+                updateSpectrumTap(fft_output_, current_fft_size);
+            }
+            if (scan_band) {
+                updateBandScan(fft_output_, current_fft_size);
+            }
+        }
+        
+        // Apply filter (and noise reduction mask), measuring passband power on the way
+        if (kernel_ready) {
+            if (apply_nr) {
+                updateNoiseReductionGains(samples + pos, block_size, full_block, hop, current_fft_size);
+            }
+            
+            BlockPower power = {};
+            apply_kernel(fft_output_, kernel, nr_gains_.data(), current_fft_size, kernel_bands_, power);
+            
+            if (full_block) {
+                publishPassbandMeasurement(power.in_band, power.out_band, power.in_band_bins,
+                                           power.peak, power.peak_bin, current_fft_size);
+            }
+        }
+        
+        // Inverse FFT
+        fft_backend_->inverse(fft_output_, fft_input_);
+        
+        // Extract the valid outputs with normalization
+        for (size_t i = 0; i < block_size; ++i) {
+            samples[pos + i] = std::complex<float>(fft_input_[overlap + i][0] * norm, fft_input_[overlap + i][1] * norm);
+        }
+        
+        pos += block_size;
+    }
+    
+    return true;
+}
+
+void DynamicBandpassFilter::updateNoiseReductionGains(const std::complex<float>* block, size_t block_size,
+                                                      bool full_block, size_t hop, int fft_size) {
+    // Caller holds fft_mutex_, after the frame's forward FFT. The estimator never sees a
+    // zero-padded tail frame: its power depends on where the caller cut the stream, and the
+    // fast-falling noise floor would follow it down. It runs once per hop of new input on the
+    // last fft_size samples instead - the frame itself when full, otherwise the window ring,
+    // transformed in fft_input_ (free until the inverse FFT). Frames in between keep the mask.
+    const size_t window_size = static_cast<size_t>(fft_size);
+    for (size_t i = 0; i < block_size; ++i) {
+        nr_window_[nr_window_pos_] = block[i];
+        nr_window_pos_ = nr_window_pos_ + 1 == window_size ? 0 : nr_window_pos_ + 1;
+    }
+    nr_window_fill_ = std::min(nr_window_fill_ + block_size, window_size);
+    nr_new_samples_ += block_size;
+    
+    if (full_block) {
+        noise_reducer_->computeGains(fft_output_, fft_size, nr_gains_.data());
+    } else if (nr_new_samples_ >= hop && nr_window_fill_ == window_size) {
+        for (size_t i = 0; i < window_size; ++i) {
+            const std::complex<float>& sample = nr_window_[(nr_window_pos_ + i) % window_size];
+            fft_input_[i][0] = sample.real();
+            fft_input_[i][1] = sample.imag();
+        }
+        fft_backend_->forward(fft_input_, fft_input_);
+        noise_reducer_->computeGains(fft_input_, fft_size, nr_gains_.data());
+    } else {
+        // nr_gains_ still holds the last smoothed mask
+        return;
+    }
+    nr_new_samples_ = 0;
+    smoothNoiseReductionGains(fft_size);
+}
+
+void DynamicBandpassFilter::smoothNoiseReductionGains(int fft_size) {
+    // Caller holds fft_mutex_. A gain mask that changes every frame is a time-varying filter
+    // whose impulse response spans the whole frame, so part of it wraps into the kept
+    // overlap-save outputs. Smoothing the mask over time keeps consecutive frames alike, so
+    // what wraps is nearly the same from frame to frame and the joins do not click.
+    for (int i = 0; i < fft_size; ++i) {
+        float& smoothed = nr_smoothed_gains_[i];
+        float target = nr_gains_[i];
+        smoothed += (target > smoothed ? NR_GAIN_ATTACK : NR_GAIN_RELEASE) * (target - smoothed);
+    }
+    
+    // A [1 2 1] pass across bins tapers that impulse response towards lag zero, so less of it
+    // reaches past the frame's real samples - into the zero padding of a short frame, which
+    // would otherwise make the result depend on where the caller cut the stream
+    const std::vector<float>& smoothed = nr_smoothed_gains_;
+    for (int i = 0; i < fft_size; ++i) {
+        int below = i == 0 ? fft_size - 1 : i - 1;
+        int above = i + 1 == fft_size ? 0 : i + 1;
+        nr_gains_[i] = 0.25f * smoothed[below] + 0.5f * smoothed[i] + 0.25f * smoothed[above];
     }
 }
 
 void DynamicBandpassFilter::processInPlace(std::vector<std::complex<float>>& samples) {
-    if (!isValidForProcessing() || samples.empty()) {
+    // Resized to the output count when pre-decimation is active
+    if (init_state_.load() == INITIALIZING) {
+        samples.resize(outputWhileInitializing(samples.data(), samples.size(), samples.data()));
+        return;
+    }
+    if (samples.empty()) {
+        return;
+    }
+    if (!isValidForProcessing()) {
+        samples.resize(passThrough(samples.data(), samples.size(), samples.data(), samples.size(), false));
         return;
     }
     
@@ -405,10 +1502,60 @@ void DynamicBandpassFilter::processInPlace(std::vector<std::complex<float>>& sam
     }
 }
 
+std::vector<float> DynamicBandpassFilter::processSSBProductDetector(const std::vector<std::complex<float>>& input,
+                                                                  int audio_rate, double* output_rate) {
+    std::vector<float> audio;
+    if (audio_rate <= 0 || !isSSBMode() || !isValidForProcessing()) {
+        return audio;
+    }
+    
+    // The one-sided kernel leaves only the wanted sideband in the analytic signal
+    std::vector<std::complex<float>> filtered = process(input);
+    
+    double sample_rate = getOutputSampleRate();
+    double phase_step = -2.0 * M_PI * current_center_freq_.load() / sample_rate;
+    
+    // Largest power-of-two factor that still leaves at least audio_rate
+    int decimation = 1;
+    while (sample_rate / (decimation * 2) >= audio_rate) {
+        decimation *= 2;
+    }
+    
+    std::lock_guard<std::mutex> demod_lock(ssb_demod_mutex_);
+    if (ssb_decimator_.getDecimation() != decimation) {
+        ssb_decimator_.configure(decimation);
+    }
+    
+    // Mix the carrier to DC
+    for (auto& sample : filtered) {
+        sample *= std::complex<float>(static_cast<float>(std::cos(ssb_demod_phase_)),
+                                      static_cast<float>(std::sin(ssb_demod_phase_)));
+        ssb_demod_phase_ += phase_step;
+        if (ssb_demod_phase_ > M_PI) {
+            ssb_demod_phase_ -= 2.0 * M_PI;
+        } else if (ssb_demod_phase_ < -M_PI) {
+            ssb_demod_phase_ += 2.0 * M_PI;
+        }
+    }
+    
+    // Half-band low-pass decimation, then the real part is the product detector output
+    ssb_baseband_.clear();
+    ssb_decimator_.process(filtered.data(), filtered.size(), ssb_baseband_);
+    audio.reserve(ssb_baseband_.size());
+    for (const auto& sample : ssb_baseband_) {
+        audio.push_back(sample.real());
+    }
+    
+    if (output_rate) {
+        *output_rate = sample_rate / decimation;
+    }
+    return audio;
+}
+
 void DynamicBandpassFilter::setProtocol(Protocol protocol) {
     if (!initialized_.load()) return;
     
-    std::lock_guard<std::mutex> lock(config_mutex_);
+    std::unique_lock<std::mutex> lock(config_mutex_);
     
     if (config_.protocol == protocol) {
         return;
@@ -437,13 +1584,20 @@ void DynamicBandpassFilter::setProtocol(Protocol protocol) {
         std::lock_guard<std::mutex> stats_lock(stats_mutex_);
         current_stats_.ssb_mode_active = (protocol == USB || protocol == LSB);
         current_stats_.ssb_carrier_offset_hz = defaults.carrier_offset;
+        current_stats_.stopband_attenuation_db = defaults.stopband_atten;
+        publishStatsLocked();
     }
     
+    lock.unlock();
+    
     qDebug() << "DynamicBandpassFilter: Protocol changed to" << protocol_names[protocol];
     if (protocol == USB || protocol == LSB) {
         qDebug() << "  SSB carrier offset:" << defaults.carrier_offset << "Hz";
         qDebug() << "  Sharp cutoff:" << (defaults.sharp_cutoff ? "enabled" : "disabled");
     }
+    
+    // Avoid running WFM-sized FFTs for narrow modes
+    applyAutoFFTSize();
 }
 
 void DynamicBandpassFilter::setPassband(float low_freq, float high_freq) {
@@ -461,18 +1615,42 @@ void DynamicBandpassFilter::setPassband(float low_freq, float high_freq) {
 void DynamicBandpassFilter::setCenterFrequency(float center_freq) {
     if (!initialized_.load()) return;
     
-    current_center_freq_.store(center_freq);
-    
     {
         std::lock_guard<std::mutex> lock(config_mutex_);
         config_.center_frequency = center_freq;
     }
     
+    // The AFC moves the center inside the block loop, so the move is handed to it rather
+    // than waiting out the block in flight for fft_mutex_
+    pending_center_freq_.store(center_freq);
+    pending_center_changes_.fetch_or(CENTER_CHANGE_RETUNE, std::memory_order_release);
     parameters_changed_.store(true);
     
     qDebug() << "DynamicBandpassFilter: Center frequency set to" << center_freq << "Hz";
 }
 
+void DynamicBandpassFilter::applyPendingCenterChanges() {
+    // Processing thread, between blocks. fft_mutex_ only orders this against another
+    // process() call's AFC update; no setter takes it.
+    uint32_t changes = pending_center_changes_.exchange(0, std::memory_order_acquire);
+    if (changes == 0) return;
+    
+    std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+    afc_smoothed_error_ = 0.0f;
+    if (changes & CENTER_CHANGE_RETUNE) {
+        // A new center starts with no correction, whether or not AFC was dropped as well
+        current_center_freq_.store(pending_center_freq_.load());
+        afc_offset_hz_.store(0.0f);
+        parameters_changed_.store(true);
+    } else {
+        float applied = afc_offset_hz_.exchange(0.0f);
+        if (applied != 0.0f) {
+            current_center_freq_.store(current_center_freq_.load() - applied);
+            parameters_changed_.store(true);
+        }
+    }
+}
+
 void DynamicBandpassFilter::setSSBCarrierOffset(float offset_hz) {
     if (!initialized_.load()) return;
     
@@ -488,6 +1666,7 @@ void DynamicBandpassFilter::setSSBCarrierOffset(float offset_hz) {
     {
         std::lock_guard<std::mutex> stats_lock(stats_mutex_);
         current_stats_.ssb_carrier_offset_hz = offset_hz;
+        publishStatsLocked();
     }
     
     qDebug() << "DynamicBandpassFilter: SSB carrier offset set to" << offset_hz << "Hz";
@@ -508,127 +1687,574 @@ void DynamicBandpassFilter::setSSBSharpCutoff(bool enabled) {
     qDebug() << "DynamicBandpassFilter: SSB sharp cutoff" << (enabled ? "enabled" : "disabled");
 }
 
-float DynamicBandpassFilter::getSSBCarrierOffset() const {
-    return ssb_carrier_offset_.load();
+void DynamicBandpassFilter::setAutoNotch(bool enabled) {
+    auto_notch_enabled_.store(enabled);
+    
+    if (!enabled) {
+        // Drop all notches; detection restarts from scratch when re-enabled
+        bool had_notches = false;
+        {
+            std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+            had_notches = !notch_bins_.empty();
+            notch_bins_.clear();
+        }
+        {
+            std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+            notch_counters_.clear();
+            tracked_notches_.clear();
+        }
+        active_notch_count_.store(0);
+        if (had_notches) {
+            parameters_changed_.store(true);
+        }
+    }
+    
+    qDebug() << "DynamicBandpassFilter: Auto notch" << (enabled ? "enabled" : "disabled");
 }
 
-bool DynamicBandpassFilter::isSSBMode() const {
-    std::lock_guard<std::mutex> lock(config_mutex_);
-    return (config_.protocol == USB || config_.protocol == LSB);
+void DynamicBandpassFilter::setAutoNotchParameters(float threshold_db, float persistence_seconds, int max_notches) {
+    notch_threshold_.store(std::pow(10.0f, std::max(threshold_db, 3.0f) / 10.0f));
+    notch_persistence_seconds_.store(std::max(persistence_seconds, 0.0f));
+    notch_max_count_.store(std::max(max_notches, 0));
+    
+    qDebug() << "DynamicBandpassFilter: Auto notch threshold" << threshold_db << "dB, persistence"
+             << persistence_seconds << "s, max" << max_notches << "notches";
 }
 
-float DynamicBandpassFilter::getResponse(float frequency) const {
-    if (!isValidForProcessing()) {
-        return 1.0f;
+void DynamicBandpassFilter::setSpectrumTap(bool enabled, int bins, int average_blocks) {
+    // Round bins down to a power of two so every output bin spans whole FFT bins
+    bins = std::clamp(bins, 64, SPECTRUM_TAP_MAX_BINS);
+    int pow2 = 64;
+    while (pow2 * 2 <= bins) {
+        pow2 *= 2;
     }
     
-    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+    spectrum_tap_bins_.store(pow2);
+    spectrum_tap_average_.store(std::max(1, average_blocks));
+    spectrum_tap_enabled_.store(enabled);
     
-    if (filter_kernel_.empty()) {
-        return 1.0f;
+    qDebug() << "DynamicBandpassFilter: Spectrum tap" << (enabled ? "enabled" : "disabled")
+             << "- bins:" << pow2 << "averaging:" << std::max(1, average_blocks) << "blocks";
+}
+
+bool DynamicBandpassFilter::getSpectrumSnapshot(std::vector<float>& magnitude_db, uint64_t* sequence,
+                                                double* span_hz, double* center_hz) {
+    // Take the newest published slot if there is one, otherwise re-read the last one
+    if (spectrum_middle_.load(std::memory_order_acquire) & SPECTRUM_TAP_FRESH) {
+        int prev = spectrum_middle_.exchange(spectrum_front_, std::memory_order_acq_rel);
+        spectrum_front_ = prev & 0x3;
     }
     
-    // Simple frequency to bin conversion
-    float sample_rate;
-    {
-        std::lock_guard<std::mutex> config_lock(config_mutex_);
-        sample_rate = static_cast<float>(config_.sample_rate);
+    const SpectrumTapSlot& slot = spectrum_slots_[spectrum_front_];
+    if (slot.bins <= 0) {
+        return false;
     }
     
-    float nyquist = sample_rate / 2.0f;
-    if (std::abs(frequency) > nyquist) {
-        return 0.0f;
+    magnitude_db.assign(slot.magnitude_db.begin(), slot.magnitude_db.begin() + slot.bins);
+    if (sequence) {
+        *sequence = slot.sequence;
     }
-    
-    float freq_res = frequency_resolution_.load();
-    int fft_size = fft_size_.load();
-    
-    int bin = static_cast<int>((frequency + nyquist) / freq_res);
-    bin = std::clamp(bin, 0, fft_size - 1);
-    
-    if (bin < static_cast<int>(filter_kernel_.size())) {
-        return std::abs(filter_kernel_[bin]);
+    if (span_hz) {
+        *span_hz = slot.span_hz;
     }
-    
-    return 1.0f;
-}
-
-DynamicBandpassFilter::FilterConfig DynamicBandpassFilter::getConfiguration() {
-    std::lock_guard<std::mutex> lock(config_mutex_);
-    return config_;
+    if (center_hz) {
+        *center_hz = slot.center_hz;
+    }
+    return true;
 }
 
-DynamicBandpassFilter::FilterStats DynamicBandpassFilter::getStats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
+void DynamicBandpassFilter::setScanChannels(const std::vector<ScanChannel>& channels, float activity_snr_db) {
+    if (channels.empty()) {
+        clearScanChannels();
+        return;
+    }
     
-    FilterStats stats = current_stats_;
-    stats.passband_width_hz = passband_high_hz_.load() - passband_low_hz_.load();
-    stats.current_center_freq = current_center_freq_.load();
-    stats.ssb_carrier_offset_hz = ssb_carrier_offset_.load();
+    float max_frequency = 0.0f;
+    for (const ScanChannel& channel : channels) {
+        max_frequency = std::max(max_frequency, std::abs(channel.center_hz) + std::abs(channel.bandwidth_hz) / 2.0f);
+    }
     
     {
-        std::lock_guard<std::mutex> config_lock(config_mutex_);
-        stats.stopband_attenuation_db = config_.stopband_attenuation;
-        stats.ssb_mode_active = (config_.protocol == USB || config_.protocol == LSB);
+        // Writer first, then readers: nothing touches the slots while they are resized
+        std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+        std::lock_guard<std::mutex> scan_lock(scan_mutex_);
+        scan_channels_ = channels;
+        scan_activity_snr_db_ = activity_snr_db;
+        scan_ranges_fft_size_ = 0;   // Force the bin ranges to be rebuilt
+        scan_blocks_since_noise_ = 0;
+        scan_noise_warmup_blocks_ = SCAN_NOISE_INTERVAL_BLOCKS;
+        scan_sequence_ = 0;
+        
+        for (ScanReport& slot : scan_slots_) {
+            slot.channels.resize(channels.size());
+            for (size_t c = 0; c < channels.size(); ++c) {
+                ScanResult& result = slot.channels[c];
+                result.center_hz = channels[c].center_hz;
+                result.bandwidth_hz = std::abs(channels[c].bandwidth_hz);
+                result.power_dbfs = -200.0f;
+                result.snr_db = 0.0f;
+                result.active = false;
+                result.in_range = false;
+            }
+            slot.noise_floor_dbfs = -200.0f;
+            slot.active_count = 0;
+            slot.block_sequence = 0;
+        }
+        scan_middle_.store(1);
+        scan_back_ = 0;
+        scan_front_ = 2;
     }
     
-    return stats;
+    scan_max_frequency_hz_.store(max_frequency);
+    scan_enabled_.store(true);
+    parameters_changed_.store(true);   // Pre-decimation may need to widen
+    
+    qDebug() << "DynamicBandpassFilter: Band scan over" << channels.size() << "channels up to"
+             << max_frequency << "Hz, activity threshold" << activity_snr_db << "dB";
 }
 
-void DynamicBandpassFilter::reset() {
-    if (!initialized_.load()) return;
-    
-    // Wait for processing to complete
-    while (processing_active_.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-    
-    std::fill(energy_history_.begin(), energy_history_.end(), 0.0f);
-    energy_history_idx_ = 0;
-    
+void DynamicBandpassFilter::clearScanChannels() {
+    bool was_enabled = scan_enabled_.exchange(false);
     {
-        std::lock_guard<std::mutex> config_lock(config_mutex_);
-        current_center_freq_.store(config_.center_frequency);
-        ssb_carrier_offset_.store(config_.ssb_carrier_offset);
+        std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+        std::lock_guard<std::mutex> scan_lock(scan_mutex_);
+        scan_channels_.clear();
+        for (ScanReport& slot : scan_slots_) {
+            slot.channels.clear();
+            slot.active_count = 0;
+        }
+        scan_ranges_fft_size_ = 0;
     }
+    scan_max_frequency_hz_.store(0.0f);
     
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        total_samples_processed_.store(0);
-        current_stats_.samples_processed = 0;
-        current_stats_.processing_time_ms = 0.0f;
+    if (was_enabled) {
+        parameters_changed_.store(true);
+        qDebug() << "DynamicBandpassFilter: Band scan disabled";
     }
-    
-    qDebug() << "DynamicBandpassFilter: Reset completed";
 }
 
-void DynamicBandpassFilter::designFilter() {
-    if (!isValidForProcessing()) return;
-    
-    // Use SSB-specific filter design if in SSB mode
-    Protocol current_protocol;
-    {
-        std::lock_guard<std::mutex> config_lock(config_mutex_);
-        current_protocol = config_.protocol;
+const DynamicBandpassFilter::ScanReport& DynamicBandpassFilter::acquireScanReportLocked() const {
+    // Take the newest published slot if there is one, otherwise re-read the last one
+    if (scan_middle_.load(std::memory_order_acquire) & SCAN_REPORT_FRESH) {
+        int prev = scan_middle_.exchange(scan_front_, std::memory_order_acq_rel);
+        scan_front_ = prev & 0x3;
     }
+    return scan_slots_[scan_front_];
+}
+
+bool DynamicBandpassFilter::getScanReport(ScanReport& report) const {
+    std::lock_guard<std::mutex> scan_lock(scan_mutex_);
+    const ScanReport& slot = acquireScanReportLocked();
+    if (slot.channels.empty()) {
+        return false;
+    }
+    report = slot;
+    return true;
+}
+
+std::vector<int> DynamicBandpassFilter::getActiveScanChannels() const {
+    std::vector<int> active;
+    std::lock_guard<std::mutex> scan_lock(scan_mutex_);
+    const ScanReport& slot = acquireScanReportLocked();
+    for (size_t c = 0; c < slot.channels.size(); ++c) {
+        if (slot.channels[c].active) {
+            active.push_back(static_cast<int>(c));
+        }
+    }
+    return active;
+}
+
+void DynamicBandpassFilter::setNoiseReducer(std::shared_ptr<NoiseReducer> reducer) {
+    std::shared_ptr<NoiseReducer> previous;
+    {
+        std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+        if (reducer) {
+            reducer->reset();
+        }
+        previous = std::move(noise_reducer_);
+        noise_reducer_ = std::move(reducer);
+        std::fill(nr_smoothed_gains_.begin(), nr_smoothed_gains_.end(), 1.0f);
+        nr_window_fill_ = 0;
+        nr_new_samples_ = 0;
+    }
+    // previous is released here, outside the processing lock
     
-    if (current_protocol == USB || current_protocol == LSB) {
-        designSSBFilter();
-    } else {
-        safelyUpdateKernel();
+    qDebug() << "DynamicBandpassFilter: Noise reducer" << (hasNoiseReducer() ? "attached" : "removed");
+}
+
+bool DynamicBandpassFilter::hasNoiseReducer() const {
+    std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+    return noise_reducer_ != nullptr;
+}
+
+DynamicBandpassFilter::PassbandMeasurement DynamicBandpassFilter::getPassbandMeasurement() const {
+    PassbandMeasurement measurement;
+    measurement.signal_power_dbfs = measured_signal_dbfs_.load();
+    measurement.noise_floor_dbfs = measured_noise_dbfs_.load();
+    measurement.snr_db = measurement.signal_power_dbfs - measurement.noise_floor_dbfs;
+    measurement.peak_power_dbfs = measured_peak_dbfs_.load();
+    measurement.peak_frequency_hz = measured_peak_freq_hz_.load();
+    measurement.block_sequence = measured_block_sequence_.load();
+    return measurement;
+}
+
+DynamicBandpassFilter::ResponseAnalysis DynamicBandpassFilter::analyzeResponse() const {
+    ResponseAnalysis analysis = {0.0f, 0.0f, 0.0f, 0.0f, 0, 0.0f, 0.0f, 0.0f, 0.0f};
+    
+    std::vector<std::complex<float>> kernel;
+    Protocol protocol;
+    float low, high, carrier;
+    int kernel_length;
+    {
+        std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+        if (!kernel_designed_) return analysis;
+        int size = 0;
+        const std::complex<float>* active = activeKernelLocked(size);
+        kernel.assign(active, active + size);
+        kernel_length = activeKernelLengthLocked();
+        protocol = designed_protocol_;
+        low = designed_low_hz_;
+        high = designed_high_hz_;
+        carrier = designed_carrier_hz_;
+    }
+    
+    int n = static_cast<int>(kernel.size());
+    float freq_res = frequency_resolution_.load();
+    if (n < 16 || freq_res <= 0.0f || high <= low) return analysis;
+    
+    // Overlap-save keeps outputs from kernel_length - 1 on; only those are measured
+    const int valid_start = std::clamp(kernel_length - 1, 0, n - 16);
+    const int valid = n - valid_start;
+    
+    std::unique_ptr<FFTBackend> backend = FFTBackendSelector::instance().createFastest(n);
+    if (!backend) return analysis;
+    fftwf_complex* buffer = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * n);
+    if (!buffer) return analysis;
+    
+    const float nyquist = freq_res * n / 2.0f;
+    const float phase_scale = 2.0f * static_cast<float>(M_PI) / (freq_res * n);
+    
+    // One full frame of a unit tone through forward FFT, kernel and inverse FFT, as in process()
+    auto filterTone = [&](float freq) {
+        for (int i = 0; i < n; ++i) {
+            float phase = phase_scale * freq * i;
+            buffer[i][0] = std::cos(phase);
+            buffer[i][1] = std::sin(phase);
+        }
+        backend->forward(buffer, buffer);
+        for (int i = 0; i < n; ++i) {
+            std::complex<float> y = std::complex<float>(buffer[i][0], buffer[i][1]) * kernel[i];
+            buffer[i][0] = y.real() / n;
+            buffer[i][1] = y.imag() / n;
+        }
+        backend->inverse(buffer, buffer);
+    };
+    auto toneGainDb = [&](float freq) {
+        filterTone(freq);
+        double power = 0.0;
+        for (int i = valid_start; i < n; ++i) {
+            power += buffer[i][0] * buffer[i][0] + buffer[i][1] * buffer[i][1];
+        }
+        ++analysis.tones_measured;
+        return 10.0f * std::log10(static_cast<float>(power / valid) + 1e-20f);
+    };
+    
+    // The FIR window spreads each edge over the protocol's transition band, centred on the
+    // edge; ripple is measured inside it and attenuation outside it (at least a few bins)
+    const auto& defaults = PROTOCOL_DEFAULTS[static_cast<int>(protocol)];
+    float width = high - low;
+    float guard = std::max(width * defaults.transition_width, 4.0f * freq_res);
+    
+    // Passband: tones across the flat region, half a transition band in from each edge
+    float flat_low = low + guard / 2.0f;
+    float flat_high = high - guard / 2.0f;
+    analysis.flat_low_hz = flat_low;
+    analysis.flat_high_hz = flat_high;
+    analysis.stopband_low_hz = low - guard;
+    analysis.stopband_high_hz = high + guard;
+    if (flat_high > flat_low) {
+        float max_gain = -200.0f;
+        float min_gain = 200.0f;
+        for (int t = 0; t < ANALYSIS_PASSBAND_TONES; ++t) {
+            float freq = flat_low + (flat_high - flat_low) * (t + 0.5f) / ANALYSIS_PASSBAND_TONES;
+            float gain = toneGainDb(freq);
+            max_gain = std::max(max_gain, gain);
+            min_gain = std::min(min_gain, gain);
+        }
+        analysis.passband_ripple_db = max_gain - min_gain;
     }
     
+    // Stopband: everything past the protocol's transition band
+    float worst_stopband = -200.0f;
+    for (int t = 0; t < ANALYSIS_STOPBAND_TONES; ++t) {
+        float freq = -nyquist + 2.0f * nyquist * (t + 0.5f) / ANALYSIS_STOPBAND_TONES;
+        if (freq > low - guard && freq < high + guard) continue;
+        worst_stopband = std::max(worst_stopband, toneGainDb(freq));
+    }
+    analysis.stopband_attenuation_db = -worst_stopband;
+    
+    // SSB: the same audio offsets mirrored about the suppressed carrier
+    if (protocol == USB || protocol == LSB) {
+        double wanted = 0.0;
+        double mirrored = 0.0;
+        for (int t = 0; t < ANALYSIS_SIDEBAND_TONES; ++t) {
+            float freq = flat_low + (flat_high - flat_low) * (t + 0.5f) / ANALYSIS_SIDEBAND_TONES;
+            wanted += std::pow(10.0, toneGainDb(freq) / 10.0);
+            mirrored += std::pow(10.0, toneGainDb(2.0f * carrier - freq) / 10.0);
+        }
+        analysis.sideband_rejection_db = 10.0f * std::log10(static_cast<float>(wanted / (mirrored + 1e-30)));
+    }
+    
+    // Block edges: any wraparound left in the kept outputs (a kernel longer than the overlap)
+    // shows up as drift from the ideal scaled tone at the ends of the valid range. Fit the
+    // gain on its middle half, compare its outer eighths.
     {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        current_stats_.passband_width_hz = passband_high_hz_.load() - passband_low_hz_.load();
-        current_stats_.current_center_freq = current_center_freq_.load();
-        current_stats_.ssb_carrier_offset_hz = ssb_carrier_offset_.load();
+        float freq = low + width * 0.37f;   // Deliberately off-bin
+        filterTone(freq);
+        std::complex<float> gain_sum(0.0f, 0.0f);
+        for (int i = valid_start + valid / 4; i < valid_start + 3 * valid / 4; ++i) {
+            float phase = phase_scale * freq * i;
+            gain_sum += std::complex<float>(buffer[i][0], buffer[i][1]) * std::polar(1.0f, -phase);
+        }
+        std::complex<float> gain = gain_sum / static_cast<float>(3 * valid / 4 - valid / 4);
+        
+        double edge_error = 0.0;
+        int edge = std::max(valid / 8, 1);
+        for (int k = 0; k < 2 * edge; ++k) {
+            int i = (k < edge) ? valid_start + k : n - 2 * edge + k;
+            float phase = phase_scale * freq * i;
+            std::complex<float> error = std::complex<float>(buffer[i][0], buffer[i][1]) - gain * std::polar(1.0f, phase);
+            edge_error += std::norm(error);
+        }
+        float reference = std::norm(gain) * 2 * edge;
+        analysis.block_edge_error_db = 10.0f * std::log10(static_cast<float>(edge_error) / (reference + 1e-20f) + 1e-20f);
+        ++analysis.tones_measured;
+    }
+    
+    fftwf_free(buffer);
+    return analysis;
+}
+
+void DynamicBandpassFilter::setAdaptiveCentering(bool enabled) {
+    afc_enabled_.store(enabled);
+    
+    if (!enabled && initialized_.load()) {
+        // Drop any applied correction and return to the configured center. The block loop
+        // owns the offset, so it does the read-modify-write at its next call.
+        pending_center_changes_.fetch_or(CENTER_CHANGE_DROP_AFC, std::memory_order_release);
+    }
+    
+    {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+        current_stats_.afc_active = enabled;
+        publishStatsLocked();
+    }
+    
+    qDebug() << "DynamicBandpassFilter: Adaptive centering" << (enabled ? "enabled" : "disabled");
+}
+
+void DynamicBandpassFilter::setAdaptiveCenteringRange(float max_offset_hz) {
+    if (max_offset_hz <= 0.0f) return;
+    
+    afc_max_offset_hz_.store(max_offset_hz);
+    
+    qDebug() << "DynamicBandpassFilter: Adaptive centering range set to +/-" << max_offset_hz << "Hz";
+}
+
+float DynamicBandpassFilter::getSSBCarrierOffset() const {
+    return ssb_carrier_offset_.load();
+}
+
+bool DynamicBandpassFilter::isSSBMode() const {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    return (config_.protocol == USB || config_.protocol == LSB);
+}
+
+float DynamicBandpassFilter::getResponse(float frequency) const {
+    float magnitude = 1.0f;
+    getResponse(&frequency, 1, &magnitude);
+    return magnitude;
+}
+
+bool DynamicBandpassFilter::getResponse(const float* frequencies, size_t count, float* magnitude, float* phase_rad) const {
+    if (!frequencies || !magnitude) return false;
+    
+    auto fillPassthrough = [&]() {
+        std::fill(magnitude, magnitude + count, 1.0f);
+        if (phase_rad) std::fill(phase_rad, phase_rad + count, 0.0f);
+    };
+    
+    if (!isValidForProcessing()) {
+        fillPassthrough();
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+    
+    int fft_size = 0;
+    const std::complex<float>* kernel = activeKernelLocked(fft_size);
+    float freq_res = frequency_resolution_.load();
+    if (fft_size == 0 || freq_res <= 0.0f) {
+        fillPassthrough();
+        return false;
+    }
+    
+    // The kernel is in FFT order: bin k holds k * freq_res for k <= N/2, negatives above.
+    // Working in signed bin positions and wrapping the index keeps the curve in order.
+    const float inv_res = 1.0f / freq_res;
+    const float nyquist = freq_res * fft_size / 2.0f;
+    
+    for (size_t i = 0; i < count; ++i) {
+        float frequency = frequencies[i];
+        if (std::abs(frequency) > nyquist) {
+            magnitude[i] = 0.0f;
+            if (phase_rad) phase_rad[i] = 0.0f;
+            continue;
+        }
+        
+        float position = frequency * inv_res;
+        float lower = std::floor(position);
+        float t = position - lower;
+        int k0 = static_cast<int>(lower) & (fft_size - 1);
+        int k1 = (k0 + 1) & (fft_size - 1);
         
+        // Magnitude and phase are interpolated separately so phase wraps do not cancel
+        const std::complex<float>& a = kernel[k0];
+        const std::complex<float>& b = kernel[k1];
+        magnitude[i] = std::abs(a) + t * (std::abs(b) - std::abs(a));
+        if (phase_rad) {
+            float pa = std::arg(a);
+            float step = std::remainder(std::arg(b) - pa, 2.0f * static_cast<float>(M_PI));
+            phase_rad[i] = std::remainder(pa + t * step, 2.0f * static_cast<float>(M_PI));
+        }
+    }
+    
+    return true;
+}
+
+DynamicBandpassFilter::FilterConfig DynamicBandpassFilter::getConfiguration() {
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    return config_;
+}
+
+DynamicBandpassFilter::FilterStats DynamicBandpassFilter::getStats() const {
+    // Sequence lock read: retry if a publish was in progress or happened meanwhile
+    uint64_t words[STATS_WORDS];
+    for (int attempt = 0; ; ++attempt) {
+        uint32_t before = stats_sequence_.load(std::memory_order_acquire);
+        if (before & 1u) {
+            if (attempt > 64) {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        
+        for (size_t i = 0; i < STATS_WORDS; ++i) {
+            words[i] = published_stats_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        
+        if (stats_sequence_.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    
+    FilterStats stats;
+    std::memcpy(&stats, words, sizeof(FilterStats));
+    
+    // Drops happen outside the processing path that publishes, so read them live
+    stats.pool_exhausted_drops = pool_exhausted_drops_.load();
+    stats.oversized_input_drops = oversized_input_drops_.load();
+    return stats;
+}
+
+void DynamicBandpassFilter::publishStatsLocked() {
+    // Caller holds stats_mutex_, so there is exactly one writer at a time
+    static_assert(std::is_trivially_copyable<FilterStats>::value, "FilterStats is published bytewise");
+    
+    FilterStats stats = current_stats_;
+    stats.passband_width_hz = passband_high_hz_.load() - passband_low_hz_.load();
+    stats.current_center_freq = current_center_freq_.load();
+    stats.ssb_carrier_offset_hz = ssb_carrier_offset_.load();
+    stats.fft_size = fft_size_.load();
+    stats.required_kernel_length = required_kernel_length_.load();
+    stats.pre_decimation = pre_decimation_.load();
+    stats.afc_active = afc_enabled_.load();
+    stats.afc_offset_hz = afc_offset_hz_.load();
+    stats.active_notches = active_notch_count_.load();
+    stats.signal_power_dbfs = measured_signal_dbfs_.load();
+    stats.noise_floor_dbfs = measured_noise_dbfs_.load();
+    stats.snr_db = stats.signal_power_dbfs - stats.noise_floor_dbfs;
+    
+    uint64_t words[STATS_WORDS] = {};
+    std::memcpy(words, &stats, sizeof(FilterStats));
+    
+    uint32_t sequence = stats_sequence_.load(std::memory_order_relaxed);
+    stats_sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < STATS_WORDS; ++i) {
+        published_stats_[i].store(words[i], std::memory_order_relaxed);
+    }
+    stats_sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void DynamicBandpassFilter::reset() {
+    if (!initialized_.load()) return;
+    
+    // Adaptive centering state belongs to the block loop, which runs under fft_mutex_;
+    // taking it waits out the block in flight without shutting anything off
+    {
+        std::lock_guard<std::mutex> fft_lock(fft_mutex_);
+        std::fill(energy_history_.begin(), energy_history_.end(), 0.0f);
+        energy_history_idx_ = 0;
+        afc_offset_hz_.store(0.0f);
+        afc_smoothed_error_ = 0.0f;
+        afc_blocks_since_retune_ = 0;
+        pending_center_changes_.store(0);   // The configured center below covers a staged retune
+        std::fill(overlap_history_.begin(), overlap_history_.end(), std::complex<float>(0.0f, 0.0f));
+        nr_window_fill_ = 0;
+        nr_new_samples_ = 0;
+    }
+    
+    {
+        std::lock_guard<std::mutex> demod_lock(ssb_demod_mutex_);
+        ssb_demod_phase_ = 0.0;
+        ssb_decimator_.reset();
+    }
+    
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        current_center_freq_.store(config_.center_frequency);
+        ssb_carrier_offset_.store(config_.ssb_carrier_offset);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        total_samples_processed_.store(0);
+        total_samples_bypassed_.store(0);
+        pool_exhausted_drops_.store(0);
+        oversized_input_drops_.store(0);
+        current_stats_.samples_processed = 0;
+        current_stats_.processing_time_ms = 0.0f;
+        publishStatsLocked();
+    }
+    
+    qDebug() << "DynamicBandpassFilter: Reset completed";
+}
+
+void DynamicBandpassFilter::designFilter() {
+    if (!isValidForProcessing()) return;
+    
+    Protocol current_protocol;
+    {
         std::lock_guard<std::mutex> config_lock(config_mutex_);
-        current_stats_.stopband_attenuation_db = config_.stopband_attenuation;
-        current_stats_.ssb_mode_active = (config_.protocol == USB || config_.protocol == LSB);
+        current_protocol = config_.protocol;
     }
     
+    // Single pass for every mode - SSB sideband selection is part of the kernel
+    safelyUpdateKernel();
+    publishDesignStats();
+    
     float low_cutoff = passband_low_hz_.load() + current_center_freq_.load();
     float high_cutoff = passband_high_hz_.load() + current_center_freq_.load();
     float carrier_offset = ssb_carrier_offset_.load();
@@ -639,72 +2265,175 @@ void DynamicBandpassFilter::designFilter() {
         qDebug() << "  SSB carrier offset:" << carrier_offset << "Hz";
         qDebug() << "  Effective passband:" << (low_cutoff + carrier_offset) << "Hz to" << (high_cutoff + carrier_offset) << "Hz";
     }
+    qDebug() << "  Group delay:" << group_delay_samples_.load() << "samples";
+    qDebug() << "  Kernel:" << getStats().kernel_length << "taps, spec" << required_kernel_length_.load();
 }
 
-void DynamicBandpassFilter::designSSBFilter() {
-    if (!isValidForProcessing()) return;
-    
-    safelyUpdateKernel();  // Use the enhanced kernel design that handles SSB
+void DynamicBandpassFilter::publishDesignStats() {
+    // Config-derived stats are cached here so getStats() never needs config_mutex_
+    FilterConfig config_copy;
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        config_copy = config_;
+    }
+    int kernel_length = 0;
+    {
+        std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+        kernel_length = activeKernelLengthLocked();
+    }
     
-    // Apply additional SSB-specific shaping if needed
-    int fft_size = fft_size_.load();
-    float freq_res = frequency_resolution_.load();
-    applySSBShaping(fft_size, freq_res);
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        current_stats_.kernel_length = kernel_length;
+        current_stats_.passband_width_hz = passband_high_hz_.load() - passband_low_hz_.load();
+        current_stats_.current_center_freq = current_center_freq_.load();
+        current_stats_.ssb_carrier_offset_hz = ssb_carrier_offset_.load();
+        current_stats_.stopband_attenuation_db = config_copy.stopband_attenuation;
+        current_stats_.ssb_mode_active = (config_copy.protocol == USB || config_copy.protocol == LSB);
+        current_stats_.minimum_phase_active = config_copy.minimum_phase;
+        current_stats_.group_delay_ms = (config_copy.sample_rate > 0.0)
+            ? 1000.0 * group_delay_samples_.load() * pre_decimation_.load() / config_copy.sample_rate
+            : 0.0;
+        publishStatsLocked();
+    }
 }
 
-void DynamicBandpassFilter::applySSBShaping(int fft_size, float freq_res) {
-    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
-    
-    if (filter_kernel_.size() != static_cast<size_t>(fft_size)) {
-        return;
+const std::complex<float>* DynamicBandpassFilter::activeKernelLocked(int& size) const {
+    // Caller holds filter_mutex_
+    if (mapped_kernel_) {
+        size = mapped_kernel_->fftSize();
+        return mapped_kernel_->kernel();
     }
+    size = static_cast<int>(filter_kernel_.size());
+    return filter_kernel_.data();
+}
+
+int DynamicBandpassFilter::activeKernelLengthLocked() const {
+    // Caller holds filter_mutex_
+    return mapped_kernel_ ? static_cast<int>(mapped_kernel_->header().kernel_length) : kernel_length_;
+}
+
+bool DynamicBandpassFilter::saveKernelFile(const std::string& path) const {
+    if (!initialized_.load()) return false;
     
-    Protocol current_protocol;
+    KernelFile::Header header = {};
+    std::vector<std::complex<float>> kernel;
     {
+        std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+        if (!kernel_designed_) {
+            qDebug() << "DynamicBandpassFilter: No designed kernel to save";
+            return false;
+        }
+        int size = 0;
+        const std::complex<float>* active = activeKernelLocked(size);
+        kernel.assign(active, active + size);
+        header.kernel_length = static_cast<uint32_t>(activeKernelLengthLocked());
+        header.designed_low_hz = designed_low_hz_;
+        header.designed_high_hz = designed_high_hz_;
+        header.designed_carrier_hz = designed_carrier_hz_;
+        
         std::lock_guard<std::mutex> config_lock(config_mutex_);
-        current_protocol = config_.protocol;
+        header.protocol = static_cast<uint32_t>(config_.protocol);
+        header.shape = static_cast<uint32_t>(config_.shape);
+        header.flags = (config_.ssb_sharp_cutoff ? KernelFile::FLAG_SSB_SHARP_CUTOFF : 0u) |
+                       (config_.minimum_phase ? KernelFile::FLAG_MINIMUM_PHASE : 0u);
+        header.sample_rate = config_.sample_rate;
+        header.center_frequency = config_.center_frequency;
+        header.bandwidth = config_.bandwidth;
+        header.stopband_attenuation = config_.stopband_attenuation;
+        header.ssb_carrier_offset = config_.ssb_carrier_offset;
     }
     
-    if (current_protocol != USB && current_protocol != LSB) {
-        return;
-    }
+    header.fft_size = static_cast<uint32_t>(kernel.size());
+    header.pre_decimation = static_cast<uint32_t>(pre_decimation_.load());
+    header.passband_low_hz = passband_low_hz_.load();
+    header.passband_high_hz = passband_high_hz_.load();
+    header.frequency_resolution = frequency_resolution_.load();
+    header.group_delay_samples = group_delay_samples_.load();
     
-    float center_freq = current_center_freq_.load();
+    return KernelFile::write(path, header, kernel.data());
+}
+
+bool DynamicBandpassFilter::loadKernelFile(const std::string& path) {
+    if (!initialized_.load()) return false;
     
-    // Additional shaping for SSB to ensure clean sideband suppression
-    for (int i = 0; i < fft_size; ++i) {
-        float freq;
-        if (i <= fft_size / 2) {
-            freq = i * freq_res;
-        } else {
-            freq = (i - fft_size) * freq_res;
+    std::shared_ptr<const KernelFile> file = KernelFile::open(path);
+    if (!file) return false;
+    
+    const KernelFile::Header& header = file->header();
+    if (header.protocol > static_cast<uint32_t>(LSB) || header.shape > static_cast<uint32_t>(KAISER)) {
+        qDebug() << "DynamicBandpassFilter: Kernel file has an unknown protocol or shape";
+        return false;
+    }
+    
+    // Held throughout, so no design installs a kernel between the config change and the mapping
+    std::unique_lock<std::mutex> filter_lock(filter_mutex_);
+    {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        if (header.fft_size != static_cast<uint32_t>(fft_size_.load()) ||
+            std::abs(header.sample_rate - config_.sample_rate) > 1e-6) {
+            qDebug() << "DynamicBandpassFilter: Kernel file is for" << header.sample_rate << "Hz /"
+                     << header.fft_size << "bins, filter runs" << config_.sample_rate << "Hz /" << fft_size_.load();
+            return false;
         }
         
-        // Enhanced opposite sideband suppression
-        float suppression_factor = 1.0f;
+        FilterConfig loaded = config_;
+        loaded.protocol = static_cast<Protocol>(header.protocol);
+        loaded.shape = static_cast<FilterShape>(header.shape);
+        loaded.stopband_attenuation = header.stopband_attenuation;
+        loaded.center_frequency = header.center_frequency;
+        loaded.bandwidth = header.bandwidth;
+        loaded.ssb_carrier_offset = header.ssb_carrier_offset;
+        loaded.ssb_sharp_cutoff = (header.flags & KernelFile::FLAG_SSB_SHARP_CUTOFF) != 0;
+        loaded.minimum_phase = (header.flags & KernelFile::FLAG_MINIMUM_PHASE) != 0;
         
-        if (current_protocol == USB && freq < center_freq) {
-            // Suppress lower sideband for USB
-            float distance = std::abs(freq - center_freq);
-            if (distance < 3000.0f) {  // Within 3kHz of center
-                suppression_factor = 0.001f;  // -60dB suppression
-            } else {
-                suppression_factor = 0.1f;   // -20dB suppression for far frequencies
-            }
-        } else if (current_protocol == LSB && freq > center_freq) {
-            // Suppress upper sideband for LSB
-            float distance = std::abs(freq - center_freq);
-            if (distance < 3000.0f) {  // Within 3kHz of center
-                suppression_factor = 0.001f;  // -60dB suppression
-            } else {
-                suppression_factor = 0.1f;   // -20dB suppression for far frequencies
-            }
+        // The front end follows the restored passband; it has to land on the file's rate.
+        // Checked on the copy, so a mismatch leaves the running configuration alone
+        int decimation = computePreDecimation(loaded, static_cast<float>(header.center_frequency),
+                                              static_cast<float>(header.ssb_carrier_offset),
+                                              header.passband_low_hz, header.passband_high_hz);
+        if (static_cast<uint32_t>(decimation) != header.pre_decimation) {
+            qDebug() << "DynamicBandpassFilter: Kernel file expects pre-decimation" << header.pre_decimation
+                     << "but the filter would choose" << decimation;
+            return false;
         }
         
-        filter_kernel_[i] *= suppression_factor;
+        config_ = loaded;
+        passband_low_hz_.store(header.passband_low_hz);
+        passband_high_hz_.store(header.passband_high_hz);
+        current_center_freq_.store(static_cast<float>(header.center_frequency));
+        ssb_carrier_offset_.store(static_cast<float>(header.ssb_carrier_offset));
+        ssb_sharp_cutoff_.store((header.flags & KernelFile::FLAG_SSB_SHARP_CUTOFF) != 0);
+        afc_offset_hz_.store(0.0f);
+        
+        // Everything a design would produce up to here is in the file - skip it. Cleared
+        // under config_mutex_, so a setter that changes the config after this re-arms it
+        parameters_changed_.store(false);
     }
+    updatePreDecimation();
+    
+    mapped_kernel_ = file;
+    updateKernelBandsLocked();
+    kernel_designed_ = true;
+    designed_protocol_ = static_cast<Protocol>(header.protocol);
+    designed_low_hz_ = header.designed_low_hz;
+    designed_high_hz_ = header.designed_high_hz;
+    designed_carrier_hz_ = header.designed_carrier_hz;
+    notch_bins_.clear();
+    filter_lock.unlock();
+    
+    active_notch_count_.store(0);
+    group_delay_samples_.store(header.group_delay_samples);
+    publishDesignStats();
+    
+    qDebug() << "DynamicBandpassFilter: Loaded" << protocol_names[header.protocol] << "kernel from" << path.c_str();
+    return true;
 }
 
+bool DynamicBandpassFilter::isKernelFromFile() const {
+    std::lock_guard<std::mutex> filter_lock(filter_mutex_);
+    return mapped_kernel_ != nullptr;
+}
 
 void DynamicBandpassFilter::createWindow(int size, FilterShape shape, std::vector<float>& window) {
     window.resize(size);
@@ -728,15 +2457,8 @@ void DynamicBandpassFilter::createWindow(int size, FilterShape shape, std::vecto
             break;
             
         case KAISER:
-        {
-            // Simplified Kaiser window implementation
-            float beta = calculateKaiserBeta(60.0f); // Default attenuation
-            for (int i = 0; i < size; ++i) {
-                float x = 2.0f * i / (size - 1) - 1.0f;
-                window[i] = std::cosh(beta * std::sqrt(1.0f - x * x)) / std::cosh(beta);
-            }
+            KaiserWindow::fill(window.data(), size, KaiserWindow::beta(60.0)); // Default attenuation
             break;
-        }
             
         default:
             std::fill(window.begin(), window.end(), 1.0f);
@@ -744,34 +2466,497 @@ void DynamicBandpassFilter::createWindow(int size, FilterShape shape, std::vecto
     }
 }
 
-float DynamicBandpassFilter::calculateKaiserBeta(float attenuation_db) {
-    if (attenuation_db > 50.0f) {
-        return 0.1102f * (attenuation_db - 8.7f);
-    } else if (attenuation_db >= 21.0f) {
-        return 0.5842f * std::pow(attenuation_db - 21.0f, 0.4f) + 0.07886f * (attenuation_db - 21.0f);
+void DynamicBandpassFilter::updateAdaptiveCentering(const fftwf_complex* spectrum, int fft_size, int hop,
+                                                    Protocol protocol) {
+    // Called from process() with fft_mutex_ held, right after the forward FFT of a full
+    // frame. Only atomics and AFC-private state are touched here.
+    if (!spectrum || fft_size <= 0 || hop <= 0 || energy_history_.empty()) return;
+    
+    float freq_res = frequency_resolution_.load();
+    if (freq_res <= 0.0f) return;
+    
+    double block_seconds = hop / (static_cast<double>(freq_res) * fft_size);
+    int min_retune_blocks = static_cast<int>(std::ceil(AFC_MIN_RETUNE_SECONDS / block_seconds));
+    afc_blocks_since_retune_ = std::min(afc_blocks_since_retune_ + 1, min_retune_blocks);
+    
+    float center_freq = current_center_freq_.load();
+    float low = passband_low_hz_.load();
+    float high = passband_high_hz_.load();
+    float carrier_offset = ssb_carrier_offset_.load();
+    bool ssb_mode = (protocol == USB || protocol == LSB);
+    
+    // Search window: current passband plus a quarter bandwidth either side
+    float passband_center = center_freq + 0.5f * (low + high) + (ssb_mode ? carrier_offset : 0.0f);
+    float half_window = 0.5f * (high - low) + 0.25f * (high - low);
+    int first_bin = static_cast<int>(std::floor((passband_center - half_window) / freq_res));
+    int last_bin = static_cast<int>(std::ceil((passband_center + half_window) / freq_res));
+    if (last_bin - first_bin + 1 > fft_size) {
+        return;  // Passband covers the whole spectrum - nothing to track
+    }
+    
+    float energy = 0.0f;
+    float weighted_freq = 0.0f;
+    float peak_power = 0.0f;
+    int peak_bin = first_bin;
+    for (int k = first_bin; k <= last_bin; ++k) {
+        int idx = ((k % fft_size) + fft_size) % fft_size;
+        float power = spectrum[idx][0] * spectrum[idx][0] + spectrum[idx][1] * spectrum[idx][1];
+        energy += power;
+        weighted_freq += power * (k * freq_res);
+        if (power > peak_power) {
+            peak_power = power;
+            peak_bin = k;
+        }
+    }
+    
+    // Keep a short energy history so we only steer on blocks that carry signal
+    float mean_energy = 0.0f;
+    for (float e : energy_history_) {
+        mean_energy += e;
+    }
+    mean_energy /= energy_history_.size();
+    energy_history_[energy_history_idx_] = energy;
+    energy_history_idx_ = (energy_history_idx_ + 1) % energy_history_.size();
+    
+    if (energy <= 1e-12f || energy < mean_energy) {
+        return;  // Fade or silence - hold the last correction
+    }
+    
+    float estimate;
+    if (protocol == AM) {
+        // AM-style carrier: parabolic interpolation around the strongest bin
+        auto power_at = [&](int k) {
+            int idx = ((k % fft_size) + fft_size) % fft_size;
+            return spectrum[idx][0] * spectrum[idx][0] + spectrum[idx][1] * spectrum[idx][1];
+        };
+        float left = power_at(peak_bin - 1);
+        float right = power_at(peak_bin + 1);
+        float denom = left - 2.0f * peak_power + right;
+        float delta = (std::abs(denom) > 1e-20f) ? 0.5f * (left - right) / denom : 0.0f;
+        estimate = (peak_bin + std::clamp(delta, -0.5f, 0.5f)) * freq_res;
     } else {
-        return 0.0f;
+        // Power centroid of the passband content
+        estimate = weighted_freq / energy;
     }
+    
+    float error = estimate - passband_center;
+    afc_smoothed_error_ += adaptive_alpha_ * (error - afc_smoothed_error_);
+    
+    // Ignore sub-bin wander, and keep retunes apart, so the kernel is not redesigned every block
+    if (std::abs(afc_smoothed_error_) < 0.5f * freq_res) return;
+    if (afc_blocks_since_retune_ < min_retune_blocks) return;
+    
+    float max_offset = afc_max_offset_hz_.load();
+    float old_offset = afc_offset_hz_.load();
+    // Retunes are rate-limited, so each one takes the whole smoothed error
+    float new_offset = std::clamp(old_offset + afc_smoothed_error_, -max_offset, max_offset);
+    if (new_offset == old_offset) return;
+    
+    afc_offset_hz_.store(new_offset);
+    current_center_freq_.store(center_freq + (new_offset - old_offset));
+    afc_smoothed_error_ -= (new_offset - old_offset);
+    afc_blocks_since_retune_ = 0;
+    kernel_retune_pending_.store(true);  // Kernel follows on the next process() call
 }
 
-void DynamicBandpassFilter::updateAdaptiveCentering(const std::vector<std::complex<float>>& spectrum) {
-    // Disabled for simplicity - could be enhanced for SSB auto-tuning
-    (void)spectrum;
+void DynamicBandpassFilter::updateNotchBank(const fftwf_complex* spectrum, int fft_size, int hop, Protocol protocol) {
+    // Called from process() with fft_mutex_ and filter_mutex_ held, right after the forward FFT
+    // of a full frame; frames advance by hop samples
+    if (!spectrum || fft_size < 16 || hop <= 0) return;
+    
+    float freq_res = frequency_resolution_.load();
+    if (freq_res <= 0.0f) return;
+    
+    int max_notches = notch_max_count_.load();
+    if (notch_counters_.size() != static_cast<size_t>(fft_size)) {
+        notch_counters_.assign(fft_size, 0);
+        tracked_notches_.clear();
+    }
+    if (notch_scratch_.capacity() < static_cast<size_t>(max_notches)) {
+        // Only when the limit grows; the per-block path never allocates
+        notch_scratch_.reserve(max_notches);
+        tracked_notches_.reserve(max_notches);
+        notch_bins_.reserve(max_notches);
+    }
+    
+    // Scan the passband only
+    float center_freq = current_center_freq_.load();
+    bool ssb_mode = (protocol == USB || protocol == LSB);
+    float offset = ssb_mode ? ssb_carrier_offset_.load() : 0.0f;
+    int first_bin = static_cast<int>(std::ceil((center_freq + offset + passband_low_hz_.load()) / freq_res)) + 3;
+    int last_bin = static_cast<int>(std::floor((center_freq + offset + passband_high_hz_.load()) / freq_res)) - 3;
+    if (last_bin - first_bin + 7 > fft_size) {
+        last_bin = first_bin + fft_size - 7;
+    }
+    
+    // AM/FM carriers sit at the center and must survive; SSB has no wanted carrier
+    int carrier_bin = static_cast<int>(std::lround(center_freq / freq_res));
+    int carrier_guard = ssb_mode ? -1 : 2;
+    
+    auto power_at = [&](int k) {
+        int idx = k & (fft_size - 1);
+        return spectrum[idx][0] * spectrum[idx][0] + spectrum[idx][1] * spectrum[idx][1];
+    };
+    
+    // Persistence in frames at the current processing rate
+    double block_seconds = hop / (static_cast<double>(freq_res) * fft_size);
+    int persistence = static_cast<int>(std::lround(notch_persistence_seconds_.load() / block_seconds));
+    persistence = std::clamp(persistence, 2, NOTCH_MAX_PERSISTENCE_BLOCKS);
+    float threshold = notch_threshold_.load();
+    std::vector<int>& notches = notch_scratch_;
+    notches.clear();
+    
+    for (int k = first_bin; k <= last_bin; ++k) {
+        int idx = k & (fft_size - 1);
+        float power = power_at(k);
+        
+        // Narrow peak: local maximum well above the bins 2-3 away on both sides
+        float reference = 0.25f * (power_at(k - 3) + power_at(k - 2) + power_at(k + 2) + power_at(k + 3));
+        bool peak = power > power_at(k - 1) && power >= power_at(k + 1) && power > threshold * reference &&
+                    std::abs(k - carrier_bin) > carrier_guard;
+        
+        uint16_t& counter = notch_counters_[idx];
+        if (peak) {
+            counter = static_cast<uint16_t>(std::min(counter + 1, NOTCH_COUNTER_MAX));
+        } else if (counter > 0) {
+            --counter;
+        }
+        
+        // Latch at full persistence, release below half (hysteresis)
+        bool tracked = std::find(tracked_notches_.begin(), tracked_notches_.end(), idx) != tracked_notches_.end();
+        if ((counter >= persistence || (tracked && counter >= persistence / 2)) &&
+            static_cast<int>(notches.size()) < max_notches) {
+            notches.push_back(idx);
+        }
+    }
+    
+    if (notches == tracked_notches_) return;
+    
+    tracked_notches_ = notches;
+    notch_bins_ = notches;
+    active_notch_count_.store(static_cast<int>(notches.size()));
+    kernel_retune_pending_.store(true);  // Kernel picks up the new notch set on the next process() call
 }
 
-void DynamicBandpassFilter::cleanup() {
-    // This should only be called from destructor or when we have exclusive access
+void DynamicBandpassFilter::applyNotchBank(std::complex<float>* kernel, int fft_size, float min_response,
+                                           int half_width) {
+    // Called from safelyUpdateKernel() with filter_mutex_ held
+    for (int bin : notch_bins_) {
+        if (bin < 0 || bin >= fft_size) continue;
+        
+        // Notch half_width bins either side to the stopband floor, taper the next ones for leakage
+        for (int offset = -half_width; offset <= half_width; ++offset) {
+            kernel[(bin + offset + fft_size) % fft_size] = std::complex<float>(min_response, 0.0f);
+        }
+        for (int side : {-1, 1}) {
+            int neighbour = (bin + side * (half_width + 1) + fft_size) % fft_size;
+            kernel[neighbour] *= 0.25f;
+        }
+    }
+}
+
+template <DynamicBandpassFilter::Protocol P, bool SharpCutoff>
+void DynamicBandpassFilter::designKernel(std::complex<float>* kernel, int fft_size, const KernelDesignParams& params) {
+    constexpr bool ssb_mode = (P == USB || P == LSB);
+    const float low_cutoff = params.low_cutoff;
+    const float high_cutoff = params.high_cutoff;
+    const float freq_res = params.freq_res;
+    
+    for (int i = 0; i < fft_size; ++i) {
+        // Convert FFT bin to frequency
+        float freq;
+        if (i <= fft_size / 2) {
+            freq = i * freq_res;
+        } else {
+            freq = (i - fft_size) * freq_res;
+        }
+        
+        float response = 0.0f;
+        
+        if constexpr (ssb_mode) {
+            // Complex one-sided bandpass on the analytic IQ signal
+            bool opposite_sideband = (P == USB) ? (freq < params.carrier_freq) : (freq > params.carrier_freq);
+            if (opposite_sideband) {
+                // Unwanted sideband stays at the stopband floor
+            } else if constexpr (SharpCutoff) {
+                // Sharp cutoff for SSB with steeper transition
+                float transition = freq_res * 1.0f;  // Narrower transition for SSB
+                
+                if (freq >= low_cutoff && freq <= high_cutoff) {
+                    response = 1.0f;
+                } else if (freq >= low_cutoff - transition && freq < low_cutoff) {
+                    // Steeper transition
+                    float t = (freq - (low_cutoff - transition)) / transition;
+                    response = t * t * (3.0f - 2.0f * t);  // Smooth step function
+                } else if (freq > high_cutoff && freq <= high_cutoff + transition) {
+                    float t = ((high_cutoff + transition) - freq) / transition;
+                    response = t * t * (3.0f - 2.0f * t);  // Smooth step function
+                }
+            } else {
+                // Standard rectangular filter
+                if (freq >= low_cutoff && freq <= high_cutoff) {
+                    response = 1.0f;
+                }
+            }
+        } else {
+            // Standard filter for non-SSB modes
+            if (freq >= low_cutoff && freq <= high_cutoff) {
+                response = 1.0f;
+            } else {
+                // Add transition zone
+                float transition = freq_res * 2.0f;
+                if (freq >= low_cutoff - transition && freq < low_cutoff) {
+                    response = (freq - (low_cutoff - transition)) / transition;
+                } else if (freq > high_cutoff && freq <= high_cutoff + transition) {
+                    response = ((high_cutoff + transition) - freq) / transition;
+                }
+            }
+        }
+        
+        // Apply stopband attenuation
+        response = std::max(response, params.min_response);
+        
+        kernel[i] = std::complex<float>(response, 0.0f);
+    }
+}
+
+DynamicBandpassFilter::KernelDesignFn DynamicBandpassFilter::selectKernelDesign(Protocol protocol, bool sharp_cutoff) {
+    switch (protocol) {
+        case USB:
+            return sharp_cutoff ? &designKernel<USB, true> : &designKernel<USB, false>;
+        case LSB:
+            return sharp_cutoff ? &designKernel<LSB, true> : &designKernel<LSB, false>;
+        case NBFM:
+            return &designKernel<NBFM, false>;
+        case AM:
+            return &designKernel<AM, false>;
+        case WFM:
+        default:
+            return &designKernel<WFM, false>;
+    }
+}
+
+template <bool ApplyGains>
+void DynamicBandpassFilter::applyKernelToBlock(fftwf_complex* spectrum, const std::complex<float>* kernel,
+                                               const float* gains, int fft_size, const KernelBands& bands,
+                                               BlockPower& power) {
+    // In-band measurement walks the design-time runs before the spectrum is overwritten
+    float in_band_raw = 0.0f;
+    for (const auto& run : bands.runs) {
+        for (int i = run.first; i < run.second; ++i) {
+            float bin_power = spectrum[i][0] * spectrum[i][0] + spectrum[i][1] * spectrum[i][1];
+            in_band_raw += bin_power;
+            power.in_band += bin_power * bands.power[i];
+            if (bin_power > power.peak) {
+                power.peak = bin_power;
+                power.peak_bin = i;
+            }
+        }
+    }
+    power.in_band_bins = bands.in_band_bins;
     
-    if (forward_plan_) {
-        fftwf_destroy_plan(forward_plan_);
-        forward_plan_ = nullptr;
+    // Straight multiply over every bin; out-of-band power is the total less the in-band part
+    float total = 0.0f;
+    for (int i = 0; i < fft_size; ++i) {
+        std::complex<float> sample(spectrum[i][0], spectrum[i][1]);
+        total += std::norm(sample);
+        
+        std::complex<float> filtered = sample * kernel[i];
+        if constexpr (ApplyGains) {
+            filtered *= gains[i];
+        }
+        spectrum[i][0] = filtered.real();
+        spectrum[i][1] = filtered.imag();
+    }
+    power.out_band = std::max(total - in_band_raw, 0.0f);
+}
+
+void DynamicBandpassFilter::computeKernelBands(const std::complex<float>* kernel, int size, KernelBands& bands) {
+    bands.power.resize(size);
+    bands.runs.clear();
+    bands.in_band_bins = 0;
+    
+    int run_start = -1;
+    for (int i = 0; i < size; ++i) {
+        bands.power[i] = std::norm(kernel[i]);
+        bool in_band = bands.power[i] >= 0.5f;  // Within -3 dB of the passband
+        if (in_band && run_start < 0) {
+            run_start = i;
+        } else if (!in_band && run_start >= 0) {
+            bands.runs.emplace_back(run_start, i);
+            run_start = -1;
+        }
+        bands.in_band_bins += in_band ? 1 : 0;
+    }
+    if (run_start >= 0) {
+        bands.runs.emplace_back(run_start, size);
     }
+}
+
+void DynamicBandpassFilter::updateKernelBandsLocked() {
+    // Caller holds filter_mutex_
+    int size = 0;
+    const std::complex<float>* kernel = activeKernelLocked(size);
+    computeKernelBands(kernel, size, kernel_bands_);
+}
+
+void DynamicBandpassFilter::publishPassbandMeasurement(float in_band_power, float out_band_power, int in_band_bins,
+                                                       float peak_power, int peak_bin, int fft_size) {
+    // Normalize so a full-scale complex tone reads 0 dBFS
+    float scale = 1.0f / (static_cast<float>(fft_size) * static_cast<float>(fft_size));
+    int out_band_bins = fft_size - in_band_bins;
+    
+    float noise_power = 0.0f;
+    if (out_band_bins > 0) {
+        noise_power = out_band_power / out_band_bins * std::max(in_band_bins, 1);
+    }
+    
+    float peak_freq = (peak_bin <= fft_size / 2 ? peak_bin : peak_bin - fft_size) * frequency_resolution_.load();
     
-    if (inverse_plan_) {
-        fftwf_destroy_plan(inverse_plan_);
-        inverse_plan_ = nullptr;
+    measured_signal_dbfs_.store(10.0f * std::log10(in_band_power * scale + 1e-20f));
+    measured_noise_dbfs_.store(10.0f * std::log10(noise_power * scale + 1e-20f));
+    measured_peak_dbfs_.store(10.0f * std::log10(peak_power * scale + 1e-20f));
+    measured_peak_freq_hz_.store(peak_freq);
+    measured_block_sequence_.fetch_add(1);
+}
+
+void DynamicBandpassFilter::updateSpectrumTap(const fftwf_complex* spectrum, int fft_size) {
+    // Called from process() with fft_mutex_ held, right after the forward FFT
+    if (!spectrum || fft_size <= 0) return;
+    
+    int bins = std::min(spectrum_tap_bins_.load(), fft_size);
+    if (bins != spectrum_accum_bins_) {
+        // Bin count changed - restart the average
+        std::fill(spectrum_accum_.begin(), spectrum_accum_.end(), 0.0f);
+        spectrum_accum_bins_ = bins;
+        spectrum_accum_blocks_ = 0;
+    }
+    
+    // Accumulate power in display order (negative frequencies first, DC in the middle)
+    int group = fft_size / bins;
+    int half = fft_size / 2;
+    for (int j = 0; j < bins; ++j) {
+        float sum = 0.0f;
+        int shifted = j * group;
+        for (int g = 0; g < group; ++g, ++shifted) {
+            int idx = (shifted + half) & (fft_size - 1);
+            sum += spectrum[idx][0] * spectrum[idx][0] + spectrum[idx][1] * spectrum[idx][1];
+        }
+        spectrum_accum_[j] += sum;
+    }
+    
+    if (++spectrum_accum_blocks_ < spectrum_tap_average_.load()) {
+        return;
     }
     
+    // Power per output bin, normalized so a full-scale complex tone reads 0 dB
+    SpectrumTapSlot& slot = spectrum_slots_[spectrum_back_];
+    float scale = 1.0f / (static_cast<float>(spectrum_accum_blocks_) *
+                          static_cast<float>(fft_size) * static_cast<float>(fft_size));
+    for (int j = 0; j < bins; ++j) {
+        slot.magnitude_db[j] = 10.0f * std::log10(spectrum_accum_[j] * scale + 1e-20f);
+        spectrum_accum_[j] = 0.0f;
+    }
+    slot.bins = bins;
+    slot.sequence = ++spectrum_sequence_;
+    // Output bin bins / 2 groups FFT bins 0 .. group - 1, so its centre is just above DC
+    double freq_res = frequency_resolution_.load();
+    slot.span_hz = freq_res * fft_size;
+    slot.center_hz = 0.5 * (group - 1) * freq_res;
+    spectrum_accum_blocks_ = 0;
+    
+    int prev = spectrum_middle_.exchange(spectrum_back_ | SPECTRUM_TAP_FRESH, std::memory_order_acq_rel);
+    spectrum_back_ = prev & 0x3;
+}
+
+void DynamicBandpassFilter::updateBandScan(const fftwf_complex* spectrum, int fft_size) {
+    // Called from process() with fft_mutex_ held, right after the forward FFT
+    if (!spectrum || fft_size <= 0) return;
+    
+    size_t channel_count = scan_channels_.size();
+    float resolution = frequency_resolution_.load();
+    if (channel_count == 0 || resolution <= 0.0f) return;
+    
+    int half = fft_size / 2;
+    if (scan_ranges_fft_size_ != fft_size || scan_ranges_resolution_ != resolution) {
+        scan_first_bin_.resize(channel_count);
+        scan_bin_count_.resize(channel_count);
+        scan_in_range_.resize(channel_count);
+        for (size_t c = 0; c < channel_count; ++c) {
+            float half_width = std::abs(scan_channels_[c].bandwidth_hz) / 2.0f;
+            int first = static_cast<int>(std::ceil((scan_channels_[c].center_hz - half_width) / resolution)) + half;
+            int last = static_cast<int>(std::floor((scan_channels_[c].center_hz + half_width) / resolution)) + half;
+            scan_in_range_[c] = first >= 0 && last < fft_size;
+            first = std::clamp(first, 0, fft_size - 1);
+            last = std::clamp(last, 0, fft_size - 1);
+            scan_first_bin_[c] = first;
+            scan_bin_count_[c] = std::max(last - first + 1, 1);
+        }
+        scan_ranges_fft_size_ = fft_size;
+        scan_ranges_resolution_ = resolution;
+        scan_blocks_since_noise_ = 0;   // Old floor was measured at another bin width
+        scan_noise_warmup_blocks_ = SCAN_NOISE_INTERVAL_BLOCKS;
+    }
+    
+    // Noise floor from a low quantile of evenly spaced bins - robust against a band full of
+    // active channels, and it moves slowly enough to hold for a few blocks
+    if (scan_blocks_since_noise_ <= 0) {
+        int stride = std::max(1, fft_size / SCAN_NOISE_MAX_BINS);
+        int samples = fft_size / stride;
+        scan_sorted_.resize(samples);
+        for (int k = 0; k < samples; ++k) {
+            const fftwf_complex& bin = spectrum[k * stride];
+            scan_sorted_[k] = bin[0] * bin[0] + bin[1] * bin[1];
+        }
+        int quantile = static_cast<int>(SCAN_NOISE_QUANTILE * (samples - 1));
+        std::nth_element(scan_sorted_.begin(), scan_sorted_.begin() + quantile, scan_sorted_.end());
+        scan_noise_bin_power_ = std::max(scan_sorted_[quantile], 1e-30f);
+        if (scan_noise_warmup_blocks_ > 0) {
+            --scan_noise_warmup_blocks_;
+            scan_blocks_since_noise_ = 1;
+        } else {
+            scan_blocks_since_noise_ = SCAN_NOISE_INTERVAL_BLOCKS;
+        }
+    }
+    --scan_blocks_since_noise_;
+    
+    float noise_bin_power = scan_noise_bin_power_;
+    float scale = 1.0f / (static_cast<float>(fft_size) * static_cast<float>(fft_size));
+    ScanReport& report = scan_slots_[scan_back_];
+    
+    int active_count = 0;
+    for (size_t c = 0; c < channel_count; ++c) {
+        // Only the channel's own bins, mapped from display order (DC in the middle)
+        int first = scan_first_bin_[c];
+        int bins = scan_bin_count_[c];
+        float power = 0.0f;
+        for (int j = first; j < first + bins; ++j) {
+            const fftwf_complex& bin = spectrum[(j + half) & (fft_size - 1)];
+            power += bin[0] * bin[0] + bin[1] * bin[1];
+        }
+        
+        ScanResult& result = report.channels[c];
+        result.in_range = scan_in_range_[c] != 0;
+        result.power_dbfs = 10.0f * std::log10(power * scale + 1e-20f);
+        result.snr_db = 10.0f * std::log10(power / bins / noise_bin_power + 1e-20f);
+        result.active = result.in_range && result.snr_db >= scan_activity_snr_db_;
+        active_count += result.active ? 1 : 0;
+    }
+    
+    report.noise_floor_dbfs = 10.0f * std::log10(noise_bin_power * scale + 1e-20f);
+    report.active_count = active_count;
+    report.block_sequence = ++scan_sequence_;
+    
+    int prev = scan_middle_.exchange(scan_back_ | SCAN_REPORT_FRESH, std::memory_order_acq_rel);
+    scan_back_ = prev & 0x3;
+}
+
+void DynamicBandpassFilter::cleanup() {
+    // This should only be called from destructor or when we have exclusive access
+    
+    // FFTW plans inside the backend belong to the shared FFTPlanner cache
+    fft_backend_.reset();
+    
     if (fft_input_) {
         fftwf_free(fft_input_);
         fft_input_ = nullptr;
@@ -781,10 +2966,17 @@ void DynamicBandpassFilter::cleanup() {
         fftwf_free(fft_output_);
         fft_output_ = nullptr;
     }
+    fft_capacity_.store(0);
+    
+    nr_gains_.clear();
+    nr_smoothed_gains_.clear();
+    nr_window_.clear();
     
     {
         std::lock_guard<std::mutex> filter_lock(filter_mutex_);
         filter_kernel_.clear();
+        mapped_kernel_.reset();
+        kernel_bands_ = KernelBands();
     }
     
     energy_history_.clear();
@@ -820,6 +3012,7 @@ void DynamicBandpassFilter::updateFilterParameters() {
             }
         }
         
+        updatePreDecimation();
         designFilter();
         parameters_changed_.store(false);
         
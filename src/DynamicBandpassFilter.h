@@ -2,10 +2,20 @@
 #define DYNAMIC_BANDPASS_FILTER_H
 
 #include <complex>
+#include <cstdint>
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
 #include <fftw3.h>
+#include "MultistageDecimator.h"
+#include "QuiescenceGate.h"
+#include "SampleBlockPool.h"
+
+class FFTBackend;
+class KernelFile;
 
 class DynamicBandpassFilter {
 public:
@@ -17,6 +27,14 @@ public:
         LSB     // Added LSB support
     };
 
+    // Progress of initialize() / initializeAsync()
+    enum InitState {
+        UNINITIALIZED,
+        INITIALIZING,   // Samples pass through (or are muted) until READY
+        READY,
+        FAILED
+    };
+
     enum FilterShape {
         RECTANGULAR,
         HAMMING,
@@ -34,9 +52,77 @@ public:
         // SSB-specific parameters
         double ssb_carrier_offset;  // Offset from center frequency for SSB carrier
         bool ssb_sharp_cutoff;      // Enable sharper cutoff for SSB
+        bool minimum_phase;         // Cepstral minimum-phase FIR of the same length: less delay than the
+                                    // linear-phase (kernel_length - 1) / 2, phase no longer linear
         // Add other config parameters as needed
     };
 
+    // FFT/block size chosen from a filter spec (see selectFFTSize)
+    struct FFTSizeSelection {
+        int fft_size;
+        int block_size;             // Overlap-save hop: fft_size - kernel_length + 1 new samples per FFT
+        int kernel_length;          // Kaiser estimate of the FIR length, odd; cut to the budget if needed
+        double latency_ms;          // Group delay of the linear-phase kernel, (kernel_length - 1) / 2
+        bool meets_latency;         // False if the spec-length kernel had to be shortened for the budget
+    };
+
+    // Pluggable noise reduction estimator. computeGains() runs inside process() between
+    // the forward and inverse FFT and must fill one gain (0..1) per bin, FFT order.
+    // The filter smooths the mask across frames before applying it.
+    // A per-frame mask is still not a fixed FIR, so some of it wraps into the overlap-save
+    // output: deep, fast-changing masks leave faint frame-rate modulation on the noise.
+    class NoiseReducer {
+    public:
+        virtual ~NoiseReducer() = default;
+        virtual void computeGains(const fftwf_complex* spectrum, int fft_size, float* gains) = 0;
+        virtual void reset() {}
+    };
+
+    // Per-block power measurement taken while applying the kernel
+    struct PassbandMeasurement {
+        float signal_power_dbfs;    // Filtered power inside the passband
+        float noise_floor_dbfs;     // Out-of-band power per bin, scaled to the passband width
+        float snr_db;
+        float peak_power_dbfs;      // Strongest in-band bin
+        float peak_frequency_hz;
+        uint64_t block_sequence;    // Increments once per measured block
+    };
+
+    // Band scan - channels are baseband offsets from the capture centre, like the passband
+    struct ScanChannel {
+        float center_hz;
+        float bandwidth_hz;
+    };
+
+    struct ScanResult {
+        float center_hz;
+        float bandwidth_hz;
+        float power_dbfs;           // Total power inside the channel
+        float snr_db;               // Mean channel bin power over the block noise floor
+        bool active;                // snr_db at or above the activity threshold
+        bool in_range;              // False if the channel falls outside the processed band
+    };
+
+    struct ScanReport {
+        std::vector<ScanResult> channels;
+        float noise_floor_dbfs;     // Per-bin noise floor estimate of the block
+        int active_count;
+        uint64_t block_sequence;    // Increments once per scanned block, 0 = nothing yet
+    };
+
+    // Quality of the active kernel, measured with synthetic tones through the block FFT path
+    struct ResponseAnalysis {
+        float passband_ripple_db;       // Max - min gain over in-band tones
+        float stopband_attenuation_db;  // Weakest rejection outside passband + transition
+        float sideband_rejection_db;    // SSB: wanted over mirrored sideband, 0 otherwise
+        float block_edge_error_db;      // Worst error at block edges relative to an in-band tone
+        int tones_measured;             // 0 if no kernel has been designed yet
+        float flat_low_hz;              // Ripple was measured between these
+        float flat_high_hz;
+        float stopband_low_hz;          // Attenuation was measured below / above these
+        float stopband_high_hz;
+    };
+
     struct FilterStats {
         double frequency_response;
         double attenuation;
@@ -46,10 +132,31 @@ public:
         double passband_width_hz;
         double stopband_attenuation_db;
         double processing_time_ms;
+        int fft_size;
+        int required_kernel_length;         // Kaiser estimate for the protocol spec
+        int kernel_length;                  // FIR taps the active kernel actually has
+        int pre_decimation;
         double current_center_freq;
         // SSB-specific stats
         double ssb_carrier_offset_hz;
         bool ssb_mode_active;
+        // Passband group delay of the active kernel
+        double group_delay_ms;
+        bool minimum_phase_active;
+        // Adaptive centering (AFC) stats
+        bool afc_active;
+        double afc_offset_hz;       // Correction currently applied to the center frequency
+        int active_notches;         // Birdies currently notched out of the kernel
+        // Passband power measured during the kernel multiply (last full block)
+        double signal_power_dbfs;
+        double noise_floor_dbfs;
+        double snr_db;
+        // FFT backend the startup benchmark picked for fft_size
+        const char* fft_backend;            // Static name, e.g. "fftw" or "radix2"
+        double fft_backend_us;              // Benchmarked forward + inverse per block
+        // Blocks the SampleBlockPool overloads returned empty instead of filtering
+        uint64_t pool_exhausted_drops;      // No free block to write into
+        uint64_t oversized_input_drops;     // Input larger than a pool block
         // Add other stats as needed
     };
 
@@ -63,16 +170,38 @@ public:
 
     // Initialization
     bool initialize(int sample_rate, int fft_size);
-    bool isInitialized() const { 
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        return initialized_; 
-    }
+    // Allocates, plans and designs the kernel on a background thread and returns at once.
+    // Until READY, process() passes samples through unfiltered, or outputs zeros when muted,
+    // both at the decimated rate when pre-decimation is active.
+    bool initializeAsync(int sample_rate, int fft_size, bool mute_until_ready = false);
+    InitState waitForInitialization();      // Blocks until a pending initializeAsync() finishes
+    // Moves to a new sample rate / FFT size without tearing down the engine. Backend, kernel
+    // and front end are prepared on the calling thread; process() swaps them in at the start
+    // of its next block, so no samples are dropped. Falls back to initialize() if not READY.
+    bool reconfigure(int sample_rate, int fft_size);
+    bool isReconfigurePending() const { return reconfigure_pending_.load(); }
+    // Worst-case FFT size to allocate buffers for, so reconfigure() never reallocates them
+    void setMaxFFTSize(int max_fft_size);
+    // Sizes the FFT for the current protocol's transition width and attenuation. The
+    // budget bounds the kernel's group delay, which is the filter's only latency.
+    bool initializeAuto(int sample_rate, double latency_budget_ms = 50.0);
+    // Resize the engine automatically on protocol/configuration changes
+    void setAutoFFTSize(bool enabled, double latency_budget_ms = 50.0);
+    bool isAutoFFTSizeEnabled() const { return auto_fft_size_.load(); }
+    
+    // Kaiser length for the spec, shortened if its group delay exceeds the budget, and the
+    // cheapest power-of-two overlap-save FFT for that kernel
+    static FFTSizeSelection selectFFTSize(double sample_rate, double bandwidth_hz, double transition_fraction,
+                                          double stopband_atten_db, double latency_budget_ms);
+    bool isInitialized() const { return init_state_.load() == READY; }
+    InitState getInitState() const { return init_state_.load(); }
 
     // Protocol and configuration
     void setProtocol(Protocol protocol);
     void setEnabled(bool enabled);
     void configure(const FilterConfig& config);
     void setPassband(float low_freq, float high_freq);
+    // Staged, never blocking on a block in flight: the next process() call applies it
     void setCenterFrequency(float center_freq);
     
     // SSB-specific configuration methods
@@ -80,17 +209,105 @@ public:
     void setSSBSharpCutoff(bool enabled);
     float getSSBCarrierOffset() const;
     bool isSSBMode() const;
+    
+    // Adaptive centering (AFC) - tracks drift using the spectrum computed in process().
+    // Corrections are at least a quarter second apart and only redesign the kernel.
+    // Disabling drops the applied correction at the next process() call.
+    void setAdaptiveCentering(bool enabled);
+    void setAdaptiveCenteringRange(float max_offset_hz);
+    bool isAdaptiveCenteringEnabled() const { return afc_enabled_.load(); }
+    float getAdaptiveCenteringOffset() const { return afc_offset_hz_.load(); }
+
+    // Automatic notch bank - persistent narrow peaks inside the passband are notched in the kernel
+    void setAutoNotch(bool enabled);
+    // A peak must persist for persistence_seconds before it is notched
+    void setAutoNotchParameters(float threshold_db, float persistence_seconds, int max_notches);
+    bool isAutoNotchEnabled() const { return auto_notch_enabled_.load(); }
+    int getActiveNotchCount() const { return active_notch_count_.load(); }
+
+    // Spectrum tap - decimated dB magnitudes of the forward FFT computed in process().
+    // Published lock-free (triple buffer); getSpectrumSnapshot() supports a single reader.
+    // Only full frames of an enabled, initialized filter feed it: nothing is published while
+    // the filter is bypassed, and short calls may not add a frame. With pre-decimation on it
+    // shows the decimated band only, getOutputSampleRate() wide, not the capture bandwidth.
+    void setSpectrumTap(bool enabled, int bins = 1024, int average_blocks = 4);
+    bool isSpectrumTapEnabled() const { return spectrum_tap_enabled_.load(); }
+    // span_hz is the width the snapshot covers; center_hz is the baseband frequency of bin
+    // bins / 2, so bin j sits at center_hz + (j - bins / 2) * span_hz / bins
+    bool getSpectrumSnapshot(std::vector<float>& magnitude_db, uint64_t* sequence = nullptr,
+                             double* span_hz = nullptr, double* center_hz = nullptr);
+
+    // Band scan over the forward FFT of every full block. Channel powers are summed per block;
+    // the noise floor is re-estimated every few blocks from a subsample of the bins.
+    // Pre-decimation keeps the widest channel in band.
+    void setScanChannels(const std::vector<ScanChannel>& channels, float activity_snr_db = 10.0f);
+    void clearScanChannels();
+    bool isScanEnabled() const { return scan_enabled_.load(); }
+    bool getScanReport(ScanReport& report) const;
+    std::vector<int> getActiveScanChannels() const;
+
+    // Noise reduction fused into the filter's frequency-domain frame (nullptr to remove)
+    void setNoiseReducer(std::shared_ptr<NoiseReducer> reducer);
+    bool hasNoiseReducer() const;
+
+    // Passband power from the last full block - lock-free, for squelch and signal meter
+    PassbandMeasurement getPassbandMeasurement() const;
+
+    // Measures the active kernel with synthetic tones. Runs on private buffers and is safe
+    // alongside process(); tests/filter_response_test holds every protocol to its limits.
+    ResponseAnalysis analyzeResponse() const;
+
+    // Pre-decimation front end (CIC/half-band) chosen from the protocol passband and sample rate.
+    // While active, process() returns samples at getOutputSampleRate(), including when the
+    // bandpass is bypassed (disabled, initializing, or muted).
+    void setPreDecimation(bool enabled);
+    bool isPreDecimationEnabled() const { return pre_decimation_enabled_.load(); }
+    int getPreDecimation() const { return pre_decimation_.load(); }
+    double getOutputSampleRate() const;
 
     // Processing
     std::vector<std::complex<float>> process(const std::vector<std::complex<float>>& input);
     void processInPlace(std::vector<std::complex<float>>& samples);
+    // Filters into a block from a caller-supplied pool - no heap allocation in steady state.
+    // Returns an empty handle if the pool is exhausted or a block is too small for the output;
+    // each such drop is counted in FilterStats, not logged.
+    SampleBlockPool::Block process(const std::complex<float>* input, size_t count, SampleBlockPool& pool);
+    // Driver-format input: interleaved unsigned 8-bit I/Q (rtl-sdr cu8), converted straight into
+    // the output and filtered there. The buffer is only read during the call, so it can go back
+    // to the driver as soon as this returns. capacity must be at least bytes / 2 samples; a
+    // buffer that does not fit (or an exhausted pool) returns 0 / an empty block, unlogged;
+    // the pool overload counts its drops in FilterStats like process().
+    size_t processCU8(const uint8_t* buffer, size_t bytes, std::complex<float>* output, size_t capacity);
+    SampleBlockPool::Block processCU8(const uint8_t* buffer, size_t bytes, SampleBlockPool& pool);
+    
+    // SSB product detector: filters with the one-sided kernel, mixes the suppressed carrier
+    // to DC, low-pass decimates through half-band stages by the largest power of two that
+    // keeps at least audio_rate, and returns the real part. The actual rate goes to
+    // output_rate. Returns an empty vector outside USB/LSB mode.
+    std::vector<float> processSSBProductDetector(const std::vector<std::complex<float>>& input, int audio_rate,
+                                                 double* output_rate = nullptr);
     
     // Response and analysis
     float getResponse(float frequency) const;
+    // Batch query for plotting: linear magnitude and optional phase (radians) at baseband
+    // frequencies (Hz, negative allowed), interpolated between bins under a single lock.
+    // Frequencies beyond the processed Nyquist read as 0. Returns false before initialization.
+    bool getResponse(const float* frequencies, size_t count, float* magnitude, float* phase_rad = nullptr) const;
+    float getGroupDelaySamples() const { return group_delay_samples_.load(); }
+    
+    // Designed kernel files (see KernelFile). Saving writes the active kernel with its config;
+    // loading maps the file, applies its config and filters straight from the mapping until
+    // the next redesign. The file must match the current sample rate, FFT size and the
+    // pre-decimation its passband leads to; on a mismatch nothing changes and it returns false.
+    bool saveKernelFile(const std::string& path) const;
+    bool loadKernelFile(const std::string& path);
+    bool isKernelFromFile() const;
     FilterConfig getConfiguration();
     
-    // Statistics
+    // Statistics - lock-free snapshot, never blocks the processing thread
     FilterStats getStats() const;
+    // Input samples returned unfiltered (disabled, initializing, or a failed block)
+    uint64_t getSamplesBypassed() const { return total_samples_bypassed_.load(); }
     void reset();
 
 private:
@@ -99,7 +316,14 @@ private:
     std::atomic<bool> initialized_;
     std::atomic<bool> enabled_;
     std::atomic<bool> parameters_changed_;
-    std::atomic<bool> processing_active_;
+    std::atomic<bool> kernel_retune_pending_;   // AFC/notch moved: redesign the kernel only, quietly
+    QuiescenceGate processing_gate_;    // Counts filterInto() calls in flight
+    
+    // Background initialization - init_thread_mutex_ serializes (re)initialization
+    std::atomic<InitState> init_state_;
+    std::atomic<bool> mute_until_ready_;
+    std::mutex init_thread_mutex_;
+    std::thread init_thread_;
     
     // Configuration
     FilterConfig config_;
@@ -107,52 +331,288 @@ private:
     
     // FFT parameters
     std::atomic<int> fft_size_;
-    int overlap_size_;
+    std::atomic<bool> auto_fft_size_;
+    std::atomic<double> auto_fft_latency_ms_;
+    std::atomic<int> required_kernel_length_;
     std::atomic<float> frequency_resolution_;
     
-    // FFTW plans and buffers - protected by processing mutex
+    // FFT backend and buffers - protected by processing mutex
     mutable std::mutex fft_mutex_;
-    fftwf_plan forward_plan_;
-    fftwf_plan inverse_plan_;
+    std::unique_ptr<FFTBackend> fft_backend_;   // Fastest for fft_size, from FFTBackendSelector
     fftwf_complex* fft_input_;
     fftwf_complex* fft_output_;
+    std::atomic<int> fft_capacity_;     // Bins allocated in fft_input_ / fft_output_
+    std::atomic<int> max_fft_size_;
+    std::vector<std::complex<float>> overlap_history_;  // Last kernel_length - 1 inputs (overlap-save)
+    
+    // reconfigure() hand-off to the processing thread - reconfigure_mutex_ is a leaf lock
+    struct PendingReconfiguration;
+    std::mutex reconfigure_mutex_;
+    std::atomic<bool> reconfigure_pending_;
+    std::unique_ptr<PendingReconfiguration> pending_reconfiguration_;
+    
+    // Pre-decimation front end - state guarded by decimator_mutex_
+    std::mutex decimator_mutex_;
+    MultistageDecimator pre_decimator_;
+    std::atomic<bool> pre_decimation_enabled_;
+    std::atomic<int> pre_decimation_;
+    
+    // Noise reduction hook - guarded by fft_mutex_
+    std::shared_ptr<NoiseReducer> noise_reducer_;
+    std::vector<float> nr_gains_;
+    std::vector<float> nr_smoothed_gains_;  // Mask state carried across frames
+    std::vector<std::complex<float>> nr_window_;    // Ring of the last fft_size inputs, for estimator updates
+    size_t nr_window_pos_;                  // Oldest sample in nr_window_
+    size_t nr_window_fill_;                 // Samples written since reset, saturating at fft_size
+    size_t nr_new_samples_;                 // Inputs since the estimator last ran
     
     // Filter parameters
     std::vector<std::complex<float>> filter_kernel_;
+    int kernel_length_;                 // FIR taps behind filter_kernel_ - guarded by filter_mutex_
     mutable std::mutex filter_mutex_;
+    std::shared_ptr<const KernelFile> mapped_kernel_;   // Replaces filter_kernel_ while set
+    bool kernel_designed_;              // Design inputs of the active kernel, guarded by filter_mutex_
+    Protocol designed_protocol_;
+    float designed_low_hz_;
+    float designed_high_hz_;
+    float designed_carrier_hz_;
     std::atomic<float> passband_low_hz_;
     std::atomic<float> passband_high_hz_;
     std::atomic<float> current_center_freq_;
     
+    std::atomic<float> group_delay_samples_;
+    
     // SSB-specific parameters
     std::atomic<float> ssb_carrier_offset_;
     std::atomic<bool> ssb_sharp_cutoff_;
     
+    // SSB product detector state (carrier NCO and audio decimator)
+    std::mutex ssb_demod_mutex_;
+    double ssb_demod_phase_;
+    MultistageDecimator ssb_decimator_;
+    std::vector<std::complex<float>> ssb_baseband_;
+    
     // Adaptive features
     std::vector<float> energy_history_;
     size_t energy_history_idx_;
     float adaptive_alpha_;
+    std::atomic<bool> afc_enabled_;
+    std::atomic<float> afc_offset_hz_;
+    std::atomic<float> afc_max_offset_hz_;
+    float afc_smoothed_error_;
+    int afc_blocks_since_retune_;
+    
+    // Center and AFC changes staged by the setters for the processing thread, which owns
+    // current_center_freq_ / afc_offset_hz_ updates under fft_mutex_
+    enum CenterChange : uint32_t {
+        CENTER_CHANGE_RETUNE = 1u << 0,     // Move to pending_center_freq_, dropping the AFC offset
+        CENTER_CHANGE_DROP_AFC = 1u << 1    // Return the AFC offset to the configured center
+    };
+    std::atomic<float> pending_center_freq_;
+    std::atomic<uint32_t> pending_center_changes_;
+    
+    // Automatic notch bank - detection state guarded by fft_mutex_, notch_bins_ by filter_mutex_
+    std::atomic<bool> auto_notch_enabled_;
+    std::atomic<float> notch_threshold_;       // Power ratio over neighbouring bins
+    std::atomic<float> notch_persistence_seconds_;
+    std::atomic<int> notch_max_count_;
+    std::atomic<int> active_notch_count_;
+    std::vector<uint16_t> notch_counters_;     // Frames each bin has peaked, saturating
+    std::vector<int> tracked_notches_;
+    std::vector<int> notch_scratch_;           // This frame's notch set, reused
+    std::vector<int> notch_bins_;
+    
+    // Spectrum tap - slots are preallocated, the writer side is guarded by fft_mutex_
+    struct SpectrumTapSlot {
+        std::vector<float> magnitude_db;
+        int bins;
+        uint64_t sequence;
+        double span_hz;
+        double center_hz;
+    };
+    SpectrumTapSlot spectrum_slots_[3];
+    std::atomic<int> spectrum_middle_;     // Slot index, bit 2 set when unread
+    int spectrum_back_;                    // Writer-owned slot
+    int spectrum_front_;                   // Reader-owned slot
+    std::atomic<bool> spectrum_tap_enabled_;
+    std::atomic<int> spectrum_tap_bins_;
+    std::atomic<int> spectrum_tap_average_;
+    std::vector<float> spectrum_accum_;
+    int spectrum_accum_blocks_;
+    int spectrum_accum_bins_;
+    uint64_t spectrum_sequence_;
     
-    // Statistics
+    // Band scan - the writer side is guarded by fft_mutex_; reports go out through a triple
+    // buffer so readers never wait on a block. scan_mutex_ only serializes readers and
+    // resizes, and is taken after fft_mutex_.
+    mutable std::mutex scan_mutex_;
+    std::atomic<bool> scan_enabled_;
+    std::atomic<float> scan_max_frequency_hz_;
+    std::vector<ScanChannel> scan_channels_;
+    std::vector<int> scan_first_bin_;          // Display-order bin ranges, rebuilt on size/rate change
+    std::vector<int> scan_bin_count_;
+    std::vector<char> scan_in_range_;
+    int scan_ranges_fft_size_;
+    float scan_ranges_resolution_;
+    float scan_activity_snr_db_;
+    float scan_noise_bin_power_;               // Held between noise floor estimates
+    int scan_blocks_since_noise_;
+    int scan_noise_warmup_blocks_;             // Estimate every block while the first frames settle
+    std::vector<float> scan_sorted_;           // Strided bin subsample for the quantile
+    uint64_t scan_sequence_;
+    ScanReport scan_slots_[3];
+    mutable std::atomic<int> scan_middle_;     // Slot index, bit 2 set when unread
+    int scan_back_;                            // Writer-owned slot
+    mutable int scan_front_;                   // Reader-owned slot, guarded by scan_mutex_
+    
+    // Passband measurement published per block
+    std::atomic<float> measured_signal_dbfs_;
+    std::atomic<float> measured_noise_dbfs_;
+    std::atomic<float> measured_peak_dbfs_;
+    std::atomic<float> measured_peak_freq_hz_;
+    std::atomic<uint64_t> measured_block_sequence_;
+    
+    // Statistics - writers serialize on stats_mutex_ and publish through a sequence lock
     mutable std::mutex stats_mutex_;
     FilterStats current_stats_;
     std::atomic<size_t> total_samples_processed_;
+    std::atomic<uint64_t> total_samples_bypassed_;
+    std::atomic<uint64_t> pool_exhausted_drops_;
+    std::atomic<uint64_t> oversized_input_drops_;
+    static constexpr size_t STATS_WORDS = (sizeof(FilterStats) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::atomic<uint32_t> stats_sequence_;
+    std::atomic<uint64_t> published_stats_[STATS_WORDS];
+    
+    // Hot-path specializations, selected once per configuration change
+    struct KernelDesignParams {
+        float low_cutoff;
+        float high_cutoff;
+        float carrier_freq;
+        float freq_res;
+        float min_response;
+    };
+    struct BlockPower {
+        float in_band;
+        float out_band;
+        float peak;
+        int in_band_bins;
+        int peak_bin;
+    };
+    // Where the active kernel is within -3 dB of the passband, worked out once per kernel
+    // so the per-block multiply carries no per-bin branch
+    struct KernelBands {
+        std::vector<float> power;                   // |kernel|^2 per bin
+        std::vector<std::pair<int, int>> runs;      // [first, last) in-band bin ranges
+        int in_band_bins = 0;
+    };
+    struct KernelDesignRecord {
+        Protocol protocol;
+        float low_hz;               // Effective edges after SSB carrier placement
+        float high_hz;
+        float carrier_hz;
+        float min_response;
+        float group_delay_samples;
+        int kernel_length;
+    };
+    // FFT and buffers for turning a frequency-sampled design into an FIR kernel
+    struct KernelDesignScratch {
+        std::unique_ptr<FFTBackend> backend;
+        fftwf_complex* buffer;
+        int size;
+        std::vector<std::complex<float>> taps;
+        std::vector<float> window;
+        float window_beta;
+        std::vector<float> front_end_gain;      // Pre-decimation cascade magnitude per bin
+        
+        KernelDesignScratch();
+        ~KernelDesignScratch();
+        bool prepare(int fft_size);
+    };
+    struct PendingReconfiguration {
+        int sample_rate;
+        int fft_size;
+        int decimation;
+        float frequency_resolution;
+        int required_kernel_length;
+        std::unique_ptr<FFTBackend> backend;
+        double backend_us;
+        std::vector<std::complex<float>> kernel;
+        KernelBands kernel_bands;
+        KernelDesignRecord design;
+        std::vector<float> nr_gains;
+        std::vector<float> nr_smoothed_gains;
+        std::vector<std::complex<float>> nr_window;
+        MultistageDecimator decimator;      // Configured for decimation; used only if the running one differs
+        fftwf_complex* fft_input;           // Only set when fft_size exceeds the current capacity
+        fftwf_complex* fft_output;
+        int fft_capacity;
+        std::vector<std::complex<float>> overlap_history;   // Reserved alongside the larger buffers
+        
+        PendingReconfiguration();
+        ~PendingReconfiguration();
+    };
+    KernelDesignScratch design_scratch_;    // Kernel redesigns on the processing path, under filter_mutex_
+    KernelBands kernel_bands_;              // Of the active kernel, guarded by filter_mutex_
+    using KernelDesignFn = void (*)(std::complex<float>*, int, const KernelDesignParams&);
+    using BlockKernelFn = void (*)(fftwf_complex*, const std::complex<float>*, const float*, int, const KernelBands&,
+                                   BlockPower&);
+    
+    template <Protocol P, bool SharpCutoff>
+    static void designKernel(std::complex<float>* kernel, int fft_size, const KernelDesignParams& params);
+    static KernelDesignFn selectKernelDesign(Protocol protocol, bool sharp_cutoff);
+    template <bool ApplyGains>
+    static void applyKernelToBlock(fftwf_complex* spectrum, const std::complex<float>* kernel,
+                                   const float* gains, int fft_size, const KernelBands& bands, BlockPower& power);
+    static void computeKernelBands(const std::complex<float>* kernel, int size, KernelBands& bands);
+    void updateKernelBandsLocked();
     
     // Private methods
     void cleanup();
+    bool initializeEngine(int sample_rate, int fft_size);
+    size_t outputWhileInitializing(const std::complex<float>* input, size_t count, std::complex<float>* output);
+    size_t passThrough(const std::complex<float>* input, size_t count, std::complex<float>* output, size_t capacity,
+                       bool mute);
+    size_t runFrontEnd(const std::complex<float>* input, size_t count, std::complex<float>* output, size_t capacity);
     void designFilter();
     void updateFilterParameters();
+    FFTSizeSelection selectFFTSizeForConfig(double latency_budget_ms);
+    void applyAutoFFTSize();
+    int computePreDecimation(const FilterConfig& config) const;
+    int computePreDecimation(const FilterConfig& config, float center, float carrier_offset, float low,
+                             float high) const;
+    void updatePreDecimation();
+    void applyPendingCenterChanges();
     void createWindow(int size, FilterShape shape, std::vector<float>& window);
-    float calculateKaiserBeta(float attenuation_db);
-    void updateAdaptiveCentering(const std::vector<std::complex<float>>& spectrum);
-    
-    // SSB-specific filter design methods
-    void designSSBFilter();
-    void applySSBShaping(int fft_size, float freq_res);
+    void updateAdaptiveCentering(const fftwf_complex* spectrum, int fft_size, int hop, Protocol protocol);
+    void updateSpectrumTap(const fftwf_complex* spectrum, int fft_size);
+    void updateBandScan(const fftwf_complex* spectrum, int fft_size);
+    const ScanReport& acquireScanReportLocked() const;   // Caller holds scan_mutex_
+    void updateNotchBank(const fftwf_complex* spectrum, int fft_size, int hop, Protocol protocol);
+    void applyNotchBank(std::complex<float>* kernel, int fft_size, float min_response, int half_width);
+    void publishPassbandMeasurement(float in_band_power, float out_band_power, int in_band_bins,
+                                    float peak_power, int peak_bin, int fft_size);
     
     // Thread-safe helpers
     bool isValidForProcessing() const;
+    void publishStatsLocked();
+    void publishDesignStats();
+    const std::complex<float>* activeKernelLocked(int& size) const;
+    int activeKernelLengthLocked() const;
+    size_t filterInto(const std::complex<float>* input, size_t count, std::complex<float>* output, size_t capacity);
+    bool filterBlocksInPlace(std::complex<float>* samples, size_t count, Protocol block_protocol);
+    void updateNoiseReductionGains(const std::complex<float>* block, size_t block_size, bool full_block, size_t hop,
+                                   int fft_size);
+    void smoothNoiseReductionGains(int fft_size);
     void safelyUpdateKernel();
+    KernelDesignRecord designKernelInto(std::vector<std::complex<float>>& kernel, int fft_size, float freq_res,
+                                        const FilterConfig& config, bool apply_notches, int decimation,
+                                        KernelDesignScratch& scratch);
+    std::unique_ptr<PendingReconfiguration> applyPendingReconfiguration();   // Returns what it replaced
+    int designKernelLength(const FilterConfig& config, double processing_rate, int fft_size) const;
+    bool windowKernel(std::vector<std::complex<float>>& kernel, int kernel_length, float stopband_atten_db,
+                      KernelDesignScratch& scratch);
+    bool makeMinimumPhase(std::vector<std::complex<float>>& kernel, int kernel_length, KernelDesignScratch& scratch);
+    float measureGroupDelay(const std::vector<std::complex<float>>& kernel) const;
 };
 
 #endif // DYNAMIC_BANDPASS_FILTER_H
\ No newline at end of file
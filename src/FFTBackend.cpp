@@ -0,0 +1,288 @@
+#include "FFTBackend.h"
+#include "FFTPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <QDebug>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Benchmark: wall time per measured trial, number of trials (best one counts)
+static const double BENCHMARK_TRIAL_MS = 2.0;
+static const int BENCHMARK_TRIALS = 3;
+static const int BENCHMARK_MAX_REPEATS = 256;
+
+// Largest round-trip error (relative to full scale) a backend may show and still be chosen
+static const float BENCHMARK_MAX_ERROR = 1e-3f;
+
+namespace {
+
+class FFTWBackend : public FFTBackend {
+public:
+    explicit FFTWBackend(int size)
+        : FFTBackend(size)
+    {
+        // FFTW's new-array execute needs a plan with the same in-place-ness as the call
+        FFTPlanner& planner = FFTPlanner::instance();
+        forward_ = planner.complexPlan(size, FFTW_FORWARD, false);
+        inverse_ = planner.complexPlan(size, FFTW_BACKWARD, false);
+        forward_in_place_ = planner.complexPlan(size, FFTW_FORWARD, true);
+        inverse_in_place_ = planner.complexPlan(size, FFTW_BACKWARD, true);
+    }
+
+    bool isValid() const { return forward_ && inverse_ && forward_in_place_ && inverse_in_place_; }
+
+    Kind kind() const override { return FFTW; }
+
+    void forward(const fftwf_complex* input, fftwf_complex* output) override {
+        fftwf_execute_dft(input == output ? forward_in_place_ : forward_, const_cast<fftwf_complex*>(input), output);
+    }
+
+    void inverse(const fftwf_complex* input, fftwf_complex* output) override {
+        fftwf_execute_dft(input == output ? inverse_in_place_ : inverse_, const_cast<fftwf_complex*>(input), output);
+    }
+
+private:
+    // Owned by the FFTPlanner cache
+    fftwf_plan forward_;
+    fftwf_plan inverse_;
+    fftwf_plan forward_in_place_;
+    fftwf_plan inverse_in_place_;
+};
+
+class Radix2Backend : public FFTBackend {
+public:
+    explicit Radix2Backend(int size)
+        : FFTBackend(size)
+        , bit_reverse_(size)
+        , forward_twiddles_(std::max(size - 1, 1))
+        , inverse_twiddles_(std::max(size - 1, 1))
+    {
+        int bits = 0;
+        while ((1 << bits) < size) ++bits;
+        for (int i = 0; i < size; ++i) {
+            uint32_t reversed = 0;
+            for (int b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+            bit_reverse_[i] = reversed;
+        }
+
+        // Per-stage tables stored back to back: stage with half-length h starts at h - 1
+        for (int half = 1; half < size; half <<= 1) {
+            for (int k = 0; k < half; ++k) {
+                double angle = -M_PI * k / half;
+                forward_twiddles_[half - 1 + k] = std::complex<float>(static_cast<float>(std::cos(angle)),
+                                                                      static_cast<float>(std::sin(angle)));
+                inverse_twiddles_[half - 1 + k] = std::conj(forward_twiddles_[half - 1 + k]);
+            }
+        }
+    }
+
+    Kind kind() const override { return RADIX2; }
+
+    void forward(const fftwf_complex* input, fftwf_complex* output) override {
+        transform(input, output, forward_twiddles_.data());
+    }
+
+    void inverse(const fftwf_complex* input, fftwf_complex* output) override {
+        transform(input, output, inverse_twiddles_.data());
+    }
+
+private:
+    void transform(const fftwf_complex* input, fftwf_complex* output, const std::complex<float>* twiddles) {
+        const int n = size();
+        float* data = &output[0][0];
+
+        // Decimation in time: bit-reversed load, then log2(n) butterfly passes in place
+        if (input == output) {
+            for (int i = 0; i < n; ++i) {
+                int j = static_cast<int>(bit_reverse_[i]);
+                if (i < j) {
+                    std::swap(output[i][0], output[j][0]);
+                    std::swap(output[i][1], output[j][1]);
+                }
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                int j = static_cast<int>(bit_reverse_[i]);
+                output[j][0] = input[i][0];
+                output[j][1] = input[i][1];
+            }
+        }
+
+        for (int half = 1; half < n; half <<= 1) {
+            const std::complex<float>* stage = twiddles + half - 1;
+            for (int start = 0; start < n; start += 2 * half) {
+                float* a = data + 2 * start;
+                float* b = data + 2 * (start + half);
+                for (int k = 0; k < half; ++k) {
+                    // Plain float math - std::complex multiply carries inf/nan handling
+                    float wr = stage[k].real();
+                    float wi = stage[k].imag();
+                    float br = b[2 * k] * wr - b[2 * k + 1] * wi;
+                    float bi = b[2 * k] * wi + b[2 * k + 1] * wr;
+                    float ar = a[2 * k];
+                    float ai = a[2 * k + 1];
+                    a[2 * k] = ar + br;
+                    a[2 * k + 1] = ai + bi;
+                    b[2 * k] = ar - br;
+                    b[2 * k + 1] = ai - bi;
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> bit_reverse_;
+    std::vector<std::complex<float>> forward_twiddles_;
+    std::vector<std::complex<float>> inverse_twiddles_;
+};
+
+} // namespace
+
+std::unique_ptr<FFTBackend> FFTBackend::create(Kind kind, int size) {
+    if (size <= 0) return nullptr;
+
+    switch (kind) {
+    case FFTW: {
+        std::unique_ptr<FFTWBackend> backend(new FFTWBackend(size));
+        if (!backend->isValid()) return nullptr;
+        return std::unique_ptr<FFTBackend>(std::move(backend));
+    }
+    case RADIX2:
+        if ((size & (size - 1)) != 0) return nullptr;
+        return std::unique_ptr<FFTBackend>(new Radix2Backend(size));
+    default:
+        return nullptr;
+    }
+}
+
+const char* FFTBackend::kindName(Kind kind) {
+    switch (kind) {
+    case FFTW: return "fftw";
+    case RADIX2: return "radix2";
+    default: return "none";
+    }
+}
+
+FFTBackendSelector& FFTBackendSelector::instance() {
+    static FFTBackendSelector selector;
+    return selector;
+}
+
+FFTBackendSelector::Selection FFTBackendSelector::select(int size) {
+    // Held across the benchmark so concurrent first users of a size measure it once
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = selections_.find(size);
+    if (it != selections_.end()) {
+        return it->second;
+    }
+
+    Selection selection = benchmark(size);
+    selections_[size] = selection;
+    return selection;
+}
+
+std::unique_ptr<FFTBackend> FFTBackendSelector::createFastest(int size, Selection* selection) {
+    Selection chosen = select(size);
+    std::unique_ptr<FFTBackend> backend = FFTBackend::create(chosen.kind, size);
+    if (!backend && chosen.kind != FFTBackend::FFTW) {
+        chosen.kind = FFTBackend::FFTW;
+        chosen.microseconds = chosen.candidate_microseconds[FFTBackend::FFTW];
+        backend = FFTBackend::create(FFTBackend::FFTW, size);
+    }
+    if (selection) {
+        *selection = chosen;
+    }
+    return backend;
+}
+
+size_t FFTBackendSelector::cachedSelectionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return selections_.size();
+}
+
+FFTBackendSelector::Selection FFTBackendSelector::benchmark(int size) {
+    Selection selection;
+    selection.kind = FFTBackend::FFTW;
+    selection.microseconds = -1.0;
+    std::fill(std::begin(selection.candidate_microseconds), std::end(selection.candidate_microseconds), -1.0);
+
+    // Timed like the filter runs them: out of place, from an unchanging input block
+    fftwf_complex* buffer = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * size);
+    fftwf_complex* output = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * size);
+    if (!buffer || !output) {
+        if (buffer) fftwf_free(buffer);
+        if (output) fftwf_free(output);
+        return selection;
+    }
+
+    // Deterministic full-scale noise, the same for every candidate
+    std::vector<float> reference(2 * static_cast<size_t>(size));
+    uint32_t state = 0x9E3779B9u;
+    for (float& value : reference) {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    for (int k = 0; k < FFTBackend::KIND_COUNT; ++k) {
+        FFTBackend::Kind kind = static_cast<FFTBackend::Kind>(k);
+        std::unique_ptr<FFTBackend> backend = FFTBackend::create(kind, size);
+        if (!backend) continue;
+
+        // Round trip must reproduce the input before speed counts for anything
+        std::memcpy(buffer, reference.data(), sizeof(fftwf_complex) * size);
+        backend->forward(buffer, output);
+        backend->inverse(output, output);
+        float max_error = 0.0f;
+        for (int i = 0; i < 2 * size; ++i) {
+            max_error = std::max(max_error, std::abs((&output[0][0])[i] / size - reference[i]));
+        }
+        if (!(max_error <= BENCHMARK_MAX_ERROR)) {
+            qDebug() << "FFTBackendSelector:" << backend->name() << "rejected at size" << size
+                     << "- round-trip error" << max_error;
+            continue;
+        }
+
+        // Size the trial from one pair so huge sizes or slow backends stay bounded
+        auto start = Clock::now();
+        backend->forward(buffer, output);
+        backend->inverse(buffer, output);
+        double single_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        int repeats = static_cast<int>(std::min<double>(BENCHMARK_MAX_REPEATS,
+                                                        BENCHMARK_TRIAL_MS * 1000.0 / std::max(single_us, 0.01)));
+
+        double best_us = single_us;
+        for (int trial = 0; trial < BENCHMARK_TRIALS && repeats > 1; ++trial) {
+            start = Clock::now();
+            for (int r = 0; r < repeats; ++r) {
+                backend->forward(buffer, output);
+                backend->inverse(buffer, output);
+            }
+            double elapsed_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            best_us = std::min(best_us, elapsed_us / repeats);
+        }
+
+        selection.candidate_microseconds[k] = best_us;
+        if (selection.microseconds < 0.0 || best_us < selection.microseconds) {
+            selection.kind = kind;
+            selection.microseconds = best_us;
+        }
+    }
+
+    fftwf_free(output);
+    fftwf_free(buffer);
+
+    qDebug() << "FFTBackendSelector: Size" << size << "- fftw" << selection.candidate_microseconds[FFTBackend::FFTW]
+             << "us, radix2" << selection.candidate_microseconds[FFTBackend::RADIX2]
+             << "us ->" << FFTBackend::kindName(selection.kind);
+    return selection;
+}
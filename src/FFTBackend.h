@@ -0,0 +1,70 @@
+#ifndef FFT_BACKEND_H
+#define FFT_BACKEND_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <fftw3.h>
+
+// Fixed-size complex single-precision transform. Both directions are unnormalized
+// (inverse(forward(x)) == size * x). Buffers use the fftwf_complex layout, must come
+// from fftwf_malloc, and may alias (in == out). One instance per thread of use.
+class FFTBackend {
+public:
+    enum Kind {
+        FFTW,       // Shared FFTW_ESTIMATE plans from FFTPlanner
+        RADIX2,     // Built-in iterative radix-2, power-of-two sizes only, no library needed
+        KIND_COUNT
+    };
+
+    virtual ~FFTBackend() = default;
+
+    virtual Kind kind() const = 0;
+    virtual void forward(const fftwf_complex* input, fftwf_complex* output) = 0;
+    virtual void inverse(const fftwf_complex* input, fftwf_complex* output) = 0;
+
+    int size() const { return size_; }
+    const char* name() const { return kindName(kind()); }
+
+    // nullptr if the backend cannot do this size
+    static std::unique_ptr<FFTBackend> create(Kind kind, int size);
+    static const char* kindName(Kind kind);
+
+protected:
+    explicit FFTBackend(int size) : size_(size) {}
+
+private:
+    int size_;
+};
+
+// Picks the fastest backend per size with a one-off micro-benchmark (forward + inverse
+// on noise, after a round-trip accuracy check). Results are cached process-wide, so
+// only the first filter of a given size pays for the measurement.
+class FFTBackendSelector {
+public:
+    struct Selection {
+        FFTBackend::Kind kind;
+        double microseconds;            // One forward + inverse pair of the winner
+        double candidate_microseconds[FFTBackend::KIND_COUNT];   // < 0 if unavailable
+    };
+
+    static FFTBackendSelector& instance();
+
+    // Benchmarks on first use of a size; later calls return the cached result
+    Selection select(int size);
+    std::unique_ptr<FFTBackend> createFastest(int size, Selection* selection = nullptr);
+
+    size_t cachedSelectionCount() const;
+
+private:
+    FFTBackendSelector() = default;
+    FFTBackendSelector(const FFTBackendSelector&) = delete;
+    FFTBackendSelector& operator=(const FFTBackendSelector&) = delete;
+
+    Selection benchmark(int size);
+
+    mutable std::mutex mutex_;
+    std::map<int, Selection> selections_;
+};
+
+#endif // FFT_BACKEND_H
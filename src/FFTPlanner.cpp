@@ -0,0 +1,61 @@
+#include "FFTPlanner.h"
+#include <QDebug>
+
+FFTPlanner& FFTPlanner::instance() {
+    // Function-local static: construction is thread-safe and happens on first use
+    static FFTPlanner planner;
+    return planner;
+}
+
+FFTPlanner::FFTPlanner() {
+}
+
+FFTPlanner::~FFTPlanner() {
+    std::lock_guard<std::mutex> lock(planner_mutex_);
+    for (auto& entry : plans_) {
+        fftwf_destroy_plan(entry.second);
+    }
+    plans_.clear();
+}
+
+fftwf_plan FFTPlanner::complexPlan(int size, int sign, bool in_place) {
+    if (size <= 0) return nullptr;
+
+    PlanKey key(size, std::make_pair(sign, in_place));
+    std::lock_guard<std::mutex> lock(planner_mutex_);
+
+    auto it = plans_.find(key);
+    if (it != plans_.end()) {
+        return it->second;
+    }
+
+    // Plan against scratch buffers from fftwf_malloc so the plan's alignment matches
+    // every buffer callers allocate the same way
+    fftwf_complex* in = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * size);
+    fftwf_complex* out = in_place ? in : (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * size);
+    if (!in || !out) {
+        if (in) fftwf_free(in);
+        if (out && out != in) fftwf_free(out);
+        return nullptr;
+    }
+
+    fftwf_plan plan = fftwf_plan_dft_1d(size, in, out, sign, FFTW_ESTIMATE);
+
+    if (out != in) fftwf_free(out);
+    fftwf_free(in);
+
+    if (!plan) {
+        qDebug() << "FFTPlanner: Failed to plan size" << size;
+        return nullptr;
+    }
+
+    plans_[key] = plan;
+    qDebug() << "FFTPlanner: Planned size" << size << (sign == FFTW_FORWARD ? "forward" : "inverse")
+             << (in_place ? "in-place" : "out-of-place") << "- cached plans:" << plans_.size();
+    return plan;
+}
+
+size_t FFTPlanner::cachedPlanCount() const {
+    std::lock_guard<std::mutex> lock(planner_mutex_);
+    return plans_.size();
+}
@@ -0,0 +1,39 @@
+#ifndef FFT_PLANNER_H
+#define FFT_PLANNER_H
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <fftw3.h>
+
+// Process-wide FFTW planning service. The FFTW planner is not thread-safe, so every
+// plan is created and destroyed under one lock here. Plans are cached by size and
+// shared between filter instances; run them with fftwf_execute_dft() on the caller's
+// own fftwf_malloc'd buffers (execution is thread-safe, planning is not).
+class FFTPlanner {
+public:
+    static FFTPlanner& instance();
+
+    // Shared complex plan for the given size and direction (FFTW_FORWARD / FFTW_BACKWARD).
+    // in_place selects a plan for input == output. Owned by the cache - never destroy it.
+    fftwf_plan complexPlan(int size, int sign, bool in_place);
+
+    // Guard for any other direct FFTW planner calls (wisdom import/export, custom plans)
+    std::mutex& plannerMutex() { return planner_mutex_; }
+
+    size_t cachedPlanCount() const;
+
+private:
+    FFTPlanner();
+    ~FFTPlanner();
+    FFTPlanner(const FFTPlanner&) = delete;
+    FFTPlanner& operator=(const FFTPlanner&) = delete;
+
+    // Key: size, sign, in-place
+    typedef std::pair<int, std::pair<int, bool>> PlanKey;
+
+    mutable std::mutex planner_mutex_;
+    std::map<PlanKey, fftwf_plan> plans_;
+};
+
+#endif // FFT_PLANNER_H
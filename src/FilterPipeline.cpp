@@ -0,0 +1,60 @@
+#include "FilterPipeline.h"
+
+#ifdef FILTER_PIPELINE_AVAILABLE
+
+#include <algorithm>
+#include <QDebug>
+
+PipelineExecutor::PipelineExecutor(int thread_count)
+    : stopping_(false)
+{
+    if (thread_count <= 0) {
+        thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    threads_.reserve(thread_count);
+    for (int i = 0; i < thread_count; ++i) {
+        threads_.emplace_back([this]() { run(); });
+    }
+
+    qDebug() << "PipelineExecutor: Started" << thread_count << "threads";
+}
+
+PipelineExecutor::~PipelineExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void PipelineExecutor::post(std::coroutine_handle<> handle) {
+    if (!handle) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(handle);
+    }
+    wake_.notify_one();
+}
+
+void PipelineExecutor::run() {
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !ready_.empty(); });
+            if (ready_.empty()) break;   // Stopping and nothing left to run
+            handle = ready_.front();
+            ready_.pop_front();
+        }
+        handle.resume();
+    }
+}
+
+#endif // FILTER_PIPELINE_AVAILABLE
@@ -0,0 +1,327 @@
+#ifndef FILTER_PIPELINE_H
+#define FILTER_PIPELINE_H
+
+// Coroutine streaming API - only built when the compiler supports C++20 coroutines
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define FILTER_PIPELINE_AVAILABLE 1
+#endif
+#endif
+
+#ifdef FILTER_PIPELINE_AVAILABLE
+
+#include <complex>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "DynamicBandpassFilter.h"
+
+typedef std::vector<std::complex<float>> SampleBlock;
+
+// Shared worker threads that resume pipeline coroutines. A stage suspended on a full or
+// empty channel costs no thread; it is posted back here when its peer makes progress.
+class PipelineExecutor {
+public:
+    explicit PipelineExecutor(int thread_count = 0);    // 0 = hardware concurrency
+    ~PipelineExecutor();                                 // Close channels and wait() on tasks first
+
+    PipelineExecutor(const PipelineExecutor&) = delete;
+    PipelineExecutor& operator=(const PipelineExecutor&) = delete;
+
+    void post(std::coroutine_handle<> handle);
+    int getThreadCount() const { return static_cast<int>(threads_.size()); }
+
+    // co_await executor.schedule() continues the coroutine on an executor thread
+    auto schedule() {
+        struct ScheduleAwaiter {
+            PipelineExecutor* executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor->post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return ScheduleAwaiter{this};
+    }
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::vector<std::thread> threads_;
+    bool stopping_;
+};
+
+// Fire-and-forget pipeline stage. Created suspended; start() hands it to an executor and
+// wait() blocks until it finishes, rethrowing anything the stage threw.
+class PipelineTask {
+    struct State {
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+public:
+    struct promise_type {
+        std::shared_ptr<State> state = std::make_shared<State>();
+
+        PipelineTask get_return_object() {
+            return PipelineTask(std::coroutine_handle<promise_type>::from_promise(*this), state);
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            // Destroy the frame first, then signal, so wait() never races the frame's teardown
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    std::shared_ptr<State> state = handle.promise().state;
+                    handle.destroy();
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->done = true;
+                    }
+                    state->finished.notify_all();
+                }
+                void await_resume() const noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+        void return_void() {}
+        void unhandled_exception() { state->error = std::current_exception(); }
+    };
+
+    PipelineTask(PipelineTask&& other) noexcept
+        : handle_(std::exchange(other.handle_, {}))
+        , state_(std::move(other.state_))
+    {}
+    PipelineTask& operator=(PipelineTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+            state_ = std::move(other.state_);
+        }
+        return *this;
+    }
+    PipelineTask(const PipelineTask&) = delete;
+    PipelineTask& operator=(const PipelineTask&) = delete;
+    ~PipelineTask() {
+        if (handle_) handle_.destroy();   // Never started
+    }
+
+    void start(PipelineExecutor& executor) {
+        std::coroutine_handle<> handle = std::exchange(handle_, {});
+        if (handle) executor.post(handle);
+    }
+
+    void wait() {
+        if (!state_) return;
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->finished.wait(lock, [this]() { return state_->done; });
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+    }
+
+    bool isDone() const {
+        if (!state_) return true;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->done;
+    }
+
+private:
+    PipelineTask(std::coroutine_handle<promise_type> handle, std::shared_ptr<State> state)
+        : handle_(handle)
+        , state_(std::move(state))
+    {}
+
+    std::coroutine_handle<promise_type> handle_;
+    std::shared_ptr<State> state_;
+};
+
+// Bounded single-producer/single-consumer async stream between two stages.
+// co_await push() suspends while the channel is full (backpressure) and returns false
+// once the channel is closed; co_await pop() suspends while it is empty and returns
+// std::nullopt after close() once drained. Woken peers resume on the executor.
+template<typename T>
+class BlockChannel {
+public:
+    BlockChannel(PipelineExecutor& executor, size_t capacity)
+        : executor_(executor)
+        , capacity_(capacity > 0 ? capacity : 1)
+        , closed_(false)
+        , consumer_(nullptr)
+        , producer_(nullptr)
+    {}
+
+    BlockChannel(const BlockChannel&) = delete;
+    BlockChannel& operator=(const BlockChannel&) = delete;
+
+    struct PushAwaiter {
+        BlockChannel* channel;
+        T value;
+        bool accepted;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(channel->mutex_);
+            if (channel->offerLocked(value, lock, accepted)) {
+                return false;
+            }
+            channel->producer_ = this;
+            channel->producer_handle_ = handle;
+            return true;
+        }
+        bool await_resume() const noexcept { return accepted; }
+    };
+
+    struct PopAwaiter {
+        BlockChannel* channel;
+        std::optional<T> slot;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(channel->mutex_);
+            if (!channel->items_.empty()) {
+                slot.emplace(std::move(channel->items_.front()));
+                channel->items_.pop_front();
+                channel->refillFromProducerLocked(lock);
+                return false;
+            }
+            if (channel->closed_) {
+                return false;
+            }
+            channel->consumer_ = this;
+            channel->consumer_handle_ = handle;
+            return true;
+        }
+        std::optional<T> await_resume() { return std::move(slot); }
+    };
+
+    PushAwaiter push(T value) { return PushAwaiter{this, std::move(value), false}; }
+    PopAwaiter pop() { return PopAwaiter{this, std::nullopt}; }
+
+    // For plain threads feeding a pipeline (e.g. a driver callback); false when full or closed
+    bool tryPush(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool accepted = false;
+        return offerLocked(value, lock, accepted) && accepted;
+    }
+
+    // Wakes both sides; buffered blocks are still delivered to the consumer
+    void close() {
+        std::coroutine_handle<> consumer;
+        std::coroutine_handle<> producer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return;
+            closed_ = true;
+            if (consumer_) {
+                consumer = consumer_handle_;
+                consumer_ = nullptr;
+            }
+            if (producer_) {
+                producer_->accepted = false;
+                producer = producer_handle_;
+                producer_ = nullptr;
+            }
+        }
+        if (consumer) executor_.post(consumer);
+        if (producer) executor_.post(producer);
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    // Hands value to a waiting consumer or the buffer. False if the caller must wait.
+    // Releases the lock before posting anyone to the executor.
+    bool offerLocked(T& value, std::unique_lock<std::mutex>& lock, bool& accepted) {
+        if (closed_) {
+            accepted = false;
+            return true;
+        }
+        if (consumer_) {
+            consumer_->slot.emplace(std::move(value));
+            std::coroutine_handle<> consumer = consumer_handle_;
+            consumer_ = nullptr;
+            lock.unlock();
+            executor_.post(consumer);
+            accepted = true;
+            return true;
+        }
+        if (items_.size() < capacity_) {
+            items_.push_back(std::move(value));
+            accepted = true;
+            return true;
+        }
+        return false;
+    }
+
+    // A slot just freed up - move a blocked producer's value in and resume it
+    void refillFromProducerLocked(std::unique_lock<std::mutex>& lock) {
+        if (!producer_) return;
+        items_.push_back(std::move(producer_->value));
+        producer_->accepted = true;
+        std::coroutine_handle<> producer = producer_handle_;
+        producer_ = nullptr;
+        lock.unlock();
+        executor_.post(producer);
+    }
+
+    PipelineExecutor& executor_;
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::deque<T> items_;
+    bool closed_;
+    PopAwaiter* consumer_;
+    std::coroutine_handle<> consumer_handle_;
+    PushAwaiter* producer_;
+    std::coroutine_handle<> producer_handle_;
+};
+
+// Generic stage: out = fn(in) for every block until input is drained or output closes.
+// Closes both channels however it ends - drained, downstream gone, or fn threw (rethrown
+// by wait()) - so neither peer stays suspended. Channels must outlive the task.
+template<typename In, typename Out, typename Fn>
+PipelineTask transformStage(BlockChannel<In>& input, BlockChannel<Out>& output, Fn fn) {
+    // Unwinding destroys it before unhandled_exception() runs
+    struct CloseOnExit {
+        BlockChannel<In>& input;
+        BlockChannel<Out>& output;
+        ~CloseOnExit() {
+            output.close();
+            input.close();
+        }
+    } close_on_exit{input, output};
+
+    while (std::optional<In> block = co_await input.pop()) {
+        if (!co_await output.push(fn(std::move(*block)))) {
+            break;
+        }
+    }
+}
+
+// Bandpass stage - consumes raw IQ blocks and yields filtered blocks
+inline PipelineTask filterStage(DynamicBandpassFilter& filter, BlockChannel<SampleBlock>& input,
+                                BlockChannel<SampleBlock>& output) {
+    return transformStage(input, output, [&filter](SampleBlock block) { return filter.process(block); });
+}
+
+#endif // FILTER_PIPELINE_AVAILABLE
+
+#endif // FILTER_PIPELINE_H
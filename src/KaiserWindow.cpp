@@ -0,0 +1,30 @@
+#include "KaiserWindow.h"
+#include <climits>
+
+double KaiserWindow::besselI0(double x) {
+    // Power series; converges quickly for the beta values used here
+    double sum = 1.0;
+    double term = 1.0;
+    double half = x / 2.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+double KaiserWindow::beta(double attenuation_db) {
+    if (attenuation_db > 50.0) {
+        return 0.1102 * (attenuation_db - 8.7);
+    } else if (attenuation_db >= 21.0) {
+        return 0.5842 * std::pow(attenuation_db - 21.0, 0.4) + 0.07886 * (attenuation_db - 21.0);
+    }
+    return 0.0;
+}
+
+int KaiserWindow::estimateLength(double attenuation_db, double transition_fraction) {
+    if (transition_fraction <= 0.0) return INT_MAX;
+    double taps = std::ceil((attenuation_db - 7.95) / (14.36 * transition_fraction)) + 1.0;
+    return static_cast<int>(std::clamp(taps, 1.0, static_cast<double>(INT_MAX - 1))) | 1;
+}
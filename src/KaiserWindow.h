@@ -0,0 +1,36 @@
+#ifndef KAISER_WINDOW_H
+#define KAISER_WINDOW_H
+
+#include <algorithm>
+#include <cmath>
+
+// Kaiser window design shared by the bandpass kernels and the stereo MPX kernels:
+// the shape parameter and tap count for a stopband attenuation (Kaiser's empirical
+// formulas), and the window itself.
+class KaiserWindow {
+public:
+    // Modified Bessel function of the first kind, order zero
+    static double besselI0(double x);
+
+    // Shape parameter that puts the sidelobes attenuation_db down
+    static double beta(double attenuation_db);
+
+    // (A - 7.95) / (14.36 * df) + 1 taps for a transition df in cycles per sample, made odd
+    // so the linear-phase FIR has an integer group delay
+    static int estimateLength(double attenuation_db, double transition_fraction);
+
+    // Symmetric window of length taps, 1 at the centre
+    template<typename T>
+    static void fill(T* window, int length, double beta);
+};
+
+template<typename T>
+void KaiserWindow::fill(T* window, int length, double beta) {
+    double denominator = besselI0(beta);
+    for (int n = 0; n < length; ++n) {
+        double x = length > 1 ? 2.0 * n / (length - 1) - 1.0 : 0.0;
+        window[n] = static_cast<T>(besselI0(beta * std::sqrt(std::max(0.0, 1.0 - x * x))) / denominator);
+    }
+}
+
+#endif // KAISER_WINDOW_H
@@ -0,0 +1,178 @@
+#include "KernelFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <QDebug>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(KernelFile::Header) == 128, "KernelFile header layout is part of the file format");
+static_assert(sizeof(std::complex<float>) == 8, "Kernel data is stored as interleaved float pairs");
+
+// Sanity limit for fft_size read from a file
+static const uint32_t MAX_KERNEL_FFT_SIZE = 1u << 24;
+
+KernelFile::KernelFile()
+    : mapping_(nullptr)
+    , length_(0)
+#ifdef _WIN32
+    , file_handle_(nullptr)
+    , mapping_handle_(nullptr)
+#endif
+{
+}
+
+KernelFile::~KernelFile() {
+#ifdef _WIN32
+    if (mapping_) UnmapViewOfFile(mapping_);
+    if (mapping_handle_) CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    if (file_handle_) CloseHandle(static_cast<HANDLE>(file_handle_));
+#else
+    if (mapping_) munmap(mapping_, length_);
+#endif
+}
+
+const std::complex<float>* KernelFile::kernel() const {
+    return reinterpret_cast<const std::complex<float>*>(static_cast<const uint8_t*>(mapping_) + header().data_offset);
+}
+
+uint64_t KernelFile::checksum(const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < bytes; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool KernelFile::write(const std::string& path, Header header, const std::complex<float>* kernel) {
+    if (!kernel || header.fft_size == 0 || header.fft_size > MAX_KERNEL_FFT_SIZE ||
+        header.kernel_length == 0 || header.kernel_length > header.fft_size) {
+        return false;
+    }
+
+    size_t data_bytes = sizeof(std::complex<float>) * header.fft_size;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.data_offset = (sizeof(Header) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    header.data_bytes = data_bytes;
+    header.checksum = checksum(kernel, data_bytes);
+
+    // Write to a temporary name and rename, so a mapped copy is never truncated under a reader
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            qDebug() << "KernelFile: Cannot create" << temp_path.c_str();
+            return false;
+        }
+
+        std::vector<char> padding(header.data_offset - sizeof(Header), 0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char*>(kernel), static_cast<std::streamsize>(data_bytes));
+        if (!out) {
+            qDebug() << "KernelFile: Write failed for" << temp_path.c_str();
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    if (!MoveFileExA(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+#endif
+        qDebug() << "KernelFile: Cannot replace" << path.c_str();
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+    qDebug() << "KernelFile: Wrote" << header.fft_size << "bin kernel to" << path.c_str();
+    return true;
+}
+
+std::shared_ptr<const KernelFile> KernelFile::open(const std::string& path, bool verify_checksum) {
+    std::shared_ptr<KernelFile> file(new KernelFile());
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        qDebug() << "KernelFile: Cannot open" << path.c_str();
+        return nullptr;
+    }
+    file->file_handle_ = handle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(Header))) {
+        qDebug() << "KernelFile: Too short to be a kernel file:" << path.c_str();
+        return nullptr;
+    }
+    file->length_ = static_cast<size_t>(size.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        qDebug() << "KernelFile: Cannot map" << path.c_str();
+        return nullptr;
+    }
+    file->mapping_handle_ = mapping;
+    file->mapping_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        qDebug() << "KernelFile: Cannot open" << path.c_str();
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        qDebug() << "KernelFile: Too short to be a kernel file:" << path.c_str();
+        ::close(fd);
+        return nullptr;
+    }
+    file->length_ = static_cast<size_t>(st.st_size);
+
+    void* mapping = mmap(nullptr, file->length_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // The mapping keeps the file referenced
+    file->mapping_ = (mapping == MAP_FAILED) ? nullptr : mapping;
+#endif
+
+    if (!file->mapping_) {
+        qDebug() << "KernelFile: Cannot map" << path.c_str();
+        return nullptr;
+    }
+
+    const Header& header = file->header();
+    if (header.magic != MAGIC) {
+        qDebug() << "KernelFile: Not a kernel file (or wrong byte order):" << path.c_str();
+        return nullptr;
+    }
+    if (header.version != VERSION || header.header_size != sizeof(Header)) {
+        qDebug() << "KernelFile: Unsupported version" << header.version << "in" << path.c_str();
+        return nullptr;
+    }
+    if (header.fft_size == 0 || header.fft_size > MAX_KERNEL_FFT_SIZE ||
+        header.kernel_length == 0 || header.kernel_length > header.fft_size ||
+        header.data_bytes != sizeof(std::complex<float>) * header.fft_size ||
+        header.data_offset % DATA_ALIGNMENT != 0 || header.data_offset < sizeof(Header) ||
+        header.data_offset + header.data_bytes > file->length_) {
+        qDebug() << "KernelFile: Corrupt layout in" << path.c_str();
+        return nullptr;
+    }
+    if (verify_checksum && checksum(file->kernel(), header.data_bytes) != header.checksum) {
+        qDebug() << "KernelFile: Checksum mismatch in" << path.c_str();
+        return nullptr;
+    }
+
+    return file;
+}
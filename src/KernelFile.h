@@ -0,0 +1,84 @@
+#ifndef KERNEL_FILE_H
+#define KERNEL_FILE_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Versioned binary file holding one designed frequency-domain kernel plus the
+// configuration it was designed for. Version 2 kernels are the FFT of a causal FIR of
+// kernel_length taps, as the overlap-save engine needs. Layout (little-endian):
+//   [Header, 128 bytes][zero padding to data_offset][complex<float> x fft_size, FFT order]
+// data_offset is a multiple of DATA_ALIGNMENT, so a mapped file can be used in place.
+// Files are read through a read-only memory mapping that lives as long as the object.
+class KernelFile {
+public:
+    static const uint32_t MAGIC = 0x4B504244;     // "DBPK"
+    static const uint32_t VERSION = 2;
+    static const size_t DATA_ALIGNMENT = 64;
+
+    // Header flags
+    static const uint32_t FLAG_SSB_SHARP_CUTOFF = 1u << 0;
+    static const uint32_t FLAG_MINIMUM_PHASE = 1u << 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t header_size;
+        uint32_t fft_size;
+
+        // FilterConfig
+        uint32_t protocol;
+        uint32_t shape;
+        uint32_t flags;
+        uint32_t pre_decimation;
+        double sample_rate;
+        double center_frequency;
+        double bandwidth;
+        double stopband_attenuation;
+        double ssb_carrier_offset;
+
+        // Filter state the kernel was designed from
+        float passband_low_hz;
+        float passband_high_hz;
+        float frequency_resolution;
+        float group_delay_samples;
+        float designed_low_hz;          // Effective edges after SSB carrier placement
+        float designed_high_hz;
+        float designed_carrier_hz;
+        uint32_t kernel_length;         // FIR taps behind the kernel; the engine keeps kernel_length - 1 of history
+
+        uint64_t data_offset;
+        uint64_t data_bytes;
+        uint64_t checksum;              // FNV-1a 64 of the kernel data
+    };
+
+    // Fills magic, version, header_size, data_offset, data_bytes and checksum
+    static bool write(const std::string& path, Header header, const std::complex<float>* kernel);
+
+    // nullptr (with the reason logged) if the file is missing, truncated or invalid
+    static std::shared_ptr<const KernelFile> open(const std::string& path, bool verify_checksum = true);
+
+    ~KernelFile();
+    KernelFile(const KernelFile&) = delete;
+    KernelFile& operator=(const KernelFile&) = delete;
+
+    const Header& header() const { return *static_cast<const Header*>(mapping_); }
+    const std::complex<float>* kernel() const;
+    int fftSize() const { return static_cast<int>(header().fft_size); }
+
+private:
+    KernelFile();
+    static uint64_t checksum(const void* data, size_t bytes);
+
+    void* mapping_;
+    size_t length_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+};
+
+#endif // KERNEL_FILE_H
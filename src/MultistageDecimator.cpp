@@ -0,0 +1,266 @@
+#include "MultistageDecimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <QDebug>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Stage planning
+static const int CIC_ORDER = 4;
+static const int MAX_CIC_FACTOR = 256;            // 4 * 8 bits of growth + 24 bit input fits in 64 bits
+static const int FINAL_HALFBAND_ODD_TAPS = 8;     // 31-tap half-band protects the output band
+static const int EARLY_HALFBAND_ODD_TAPS = 3;     // 11 taps are enough where only far images alias in
+static const float PASSBAND_GUARD = 1.25f;        // Output Nyquist / highest wanted frequency
+
+MultistageDecimator::MultistageDecimator()
+    : decimation_(1)
+    , cic_factor_(1)
+{
+    std::memset(&cic_, 0, sizeof(cic_));
+    cic_.factor = 1;
+}
+
+void MultistageDecimator::configure(int decimation) {
+    int factor = 1;
+    while (factor * 2 <= decimation) {
+        factor *= 2;
+    }
+
+    decimation_ = factor;
+    cic_factor_ = planCICFactor(factor);
+    halfband_stages_.clear();
+
+    int remaining = factor / cic_factor_;
+    while (remaining > 1) {
+        remaining /= 2;
+        HalfBandStage stage;
+        stage.taps = designHalfBand(remaining == 1 ? FINAL_HALFBAND_ODD_TAPS : EARLY_HALFBAND_ODD_TAPS);
+        stage.odd_phase = false;
+        halfband_stages_.push_back(std::move(stage));
+    }
+
+    reset();
+
+    qDebug() << "MultistageDecimator: Decimation" << decimation_
+             << "- CIC:" << cic_factor_ << "half-band stages:" << halfband_stages_.size();
+}
+
+int MultistageDecimator::planCICFactor(int factor) {
+    // CIC takes the bulk, two half-bands finish the last octaves
+    return factor >= 16 ? std::min(factor / 4, MAX_CIC_FACTOR) : 1;
+}
+
+void MultistageDecimator::passbandMagnitude(int decimation, double output_rate, double bin_hz, int bins,
+                                            float* magnitude) {
+    // |H| of the whole cascade for the stages configure(decimation) plans, at k * bin_hz
+    // (k = 0..bins-1) in the output band. Real taps, so the response is even in frequency.
+    int factor = 1;
+    while (factor * 2 <= decimation) {
+        factor *= 2;
+    }
+    std::fill(magnitude, magnitude + bins, 1.0f);
+    if (factor <= 1 || output_rate <= 0.0) return;
+
+    const double input_rate = output_rate * factor;
+    const int cic_factor = planCICFactor(factor);
+    if (cic_factor > 1) {
+        for (int k = 1; k < bins; ++k) {
+            double x = M_PI * k * bin_hz / input_rate;
+            double h = std::sin(cic_factor * x) / (cic_factor * std::sin(x));
+            magnitude[k] *= static_cast<float>(std::pow(std::abs(h), CIC_ORDER));
+        }
+    }
+
+    const std::vector<float> final_taps = designHalfBand(FINAL_HALFBAND_ODD_TAPS);
+    const std::vector<float> early_taps = designHalfBand(EARLY_HALFBAND_ODD_TAPS);
+    double stage_rate = input_rate / cic_factor;
+    for (int remaining = factor / cic_factor; remaining > 1; remaining /= 2) {
+        const std::vector<float>& taps = (remaining == 2) ? final_taps : early_taps;
+        for (int k = 0; k < bins; ++k) {
+            double omega = 2.0 * M_PI * k * bin_hz / stage_rate;
+            double h = 0.5;
+            for (size_t t = 0; t < taps.size(); ++t) {
+                h += 2.0 * taps[t] * std::cos(omega * (2 * t + 1));
+            }
+            magnitude[k] *= static_cast<float>(std::abs(h));
+        }
+        stage_rate /= 2.0;
+    }
+}
+
+void MultistageDecimator::reset() {
+    std::memset(cic_.integrators, 0, sizeof(cic_.integrators));
+    std::memset(cic_.comb_delays, 0, sizeof(cic_.comb_delays));
+    cic_.factor = cic_factor_;
+    cic_.phase = 0;
+
+    for (auto& stage : halfband_stages_) {
+        size_t length = stage.taps.size() * 4 - 1;
+        stage.history.assign(length - 1, std::complex<float>(0.0f, 0.0f));
+        stage.odd_phase = false;
+    }
+}
+
+int MultistageDecimator::chooseDecimation(double sample_rate, double max_frequency_hz, int max_decimation) {
+    int factor = 1;
+    double required_nyquist = std::abs(max_frequency_hz) * PASSBAND_GUARD;
+    while (factor * 2 <= max_decimation && sample_rate / (factor * 2) / 2.0 >= required_nyquist) {
+        factor *= 2;
+    }
+    return factor;
+}
+
+std::vector<float> MultistageDecimator::designHalfBand(int odd_taps) {
+    // Windowed sinc at a quarter of the input rate; even offsets are zero by construction
+    int length = odd_taps * 4 - 1;
+    int centre = length / 2;
+    std::vector<float> taps(odd_taps);
+
+    float sum = 0.0f;
+    for (int k = 0; k < odd_taps; ++k) {
+        int n = 2 * k + 1;
+        float x = static_cast<float>(M_PI) * n / 2.0f;
+        float sinc = 0.5f * std::sin(x) / x;
+        float arg = 2.0f * static_cast<float>(M_PI) * (centre + n) / (length - 1);
+        float window = 0.42f - 0.5f * std::cos(arg) + 0.08f * std::cos(2.0f * arg);  // Blackman
+        taps[k] = sinc * window;
+        sum += taps[k];
+    }
+
+    // Unity DC gain: 0.5 + 2 * sum(taps) == 1
+    float scale = (sum != 0.0f) ? 0.25f / sum : 0.0f;
+    for (float& t : taps) {
+        t *= scale;
+    }
+    return taps;
+}
+
+void MultistageDecimator::process(const std::complex<float>* input, size_t count,
+                                  std::vector<std::complex<float>>& output) {
+    if (!input || count == 0) return;
+
+    if (decimation_ <= 1) {
+        output.insert(output.end(), input, input + count);
+        return;
+    }
+
+    const std::vector<std::complex<float>>& result = runStages(input, count);
+    output.insert(output.end(), result.begin(), result.end());
+}
+
+size_t MultistageDecimator::process(const std::complex<float>* input, size_t count,
+                                    std::complex<float>* output, size_t capacity) {
+    if (!input || !output || count == 0) return 0;
+
+    if (decimation_ <= 1) {
+        size_t n = std::min(count, capacity);
+        std::copy(input, input + n, output);
+        return n;
+    }
+
+    const std::vector<std::complex<float>>& result = runStages(input, count);
+    size_t n = std::min(result.size(), capacity);
+    std::copy(result.begin(), result.begin() + n, output);
+    return n;
+}
+
+const std::vector<std::complex<float>>& MultistageDecimator::runStages(const std::complex<float>* input, size_t count) {
+    // Ping-pong between two scratch buffers; they keep their capacity between calls
+    scratch_a_.clear();
+    if (cic_factor_ > 1) {
+        processCIC(input, count, scratch_a_);
+    } else {
+        scratch_a_.assign(input, input + count);
+    }
+
+    std::vector<std::complex<float>>* current = &scratch_a_;
+    std::vector<std::complex<float>>* next = &scratch_b_;
+    for (auto& stage : halfband_stages_) {
+        next->clear();
+        processHalfBand(stage, *current, *next);
+        std::swap(current, next);
+    }
+
+    return *current;
+}
+
+void MultistageDecimator::processCIC(const std::complex<float>* input, size_t count,
+                                     std::vector<std::complex<float>>& output) {
+    // Fixed-point headroom: CIC_ORDER * log2(R) bits of growth plus the input scale
+    int growth_bits = 0;
+    for (int r = cic_.factor; r > 1; r >>= 1) {
+        ++growth_bits;
+    }
+    growth_bits *= CIC_ORDER;
+    int input_bits = std::min(24, 62 - growth_bits);
+    double input_scale = std::ldexp(1.0, input_bits);
+    double output_scale = 1.0 / (std::pow(static_cast<double>(cic_.factor), CIC_ORDER) * input_scale);
+
+    output.reserve(output.size() + count / cic_.factor + 1);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t x[2] = {
+            static_cast<uint64_t>(std::llround(input[i].real() * input_scale)),
+            static_cast<uint64_t>(std::llround(input[i].imag() * input_scale))
+        };
+
+        for (int c = 0; c < 2; ++c) {
+            uint64_t acc = x[c];
+            for (int s = 0; s < CIC_ORDER; ++s) {
+                cic_.integrators[s][c] += acc;
+                acc = cic_.integrators[s][c];
+            }
+        }
+
+        if (++cic_.phase < cic_.factor) continue;
+        cic_.phase = 0;
+
+        float y[2];
+        for (int c = 0; c < 2; ++c) {
+            uint64_t acc = cic_.integrators[CIC_ORDER - 1][c];
+            for (int s = 0; s < CIC_ORDER; ++s) {
+                uint64_t delayed = cic_.comb_delays[s][c];
+                cic_.comb_delays[s][c] = acc;
+                acc -= delayed;
+            }
+            y[c] = static_cast<float>(static_cast<double>(static_cast<int64_t>(acc)) * output_scale);
+        }
+        output.emplace_back(y[0], y[1]);
+    }
+}
+
+void MultistageDecimator::processHalfBand(HalfBandStage& stage, const std::vector<std::complex<float>>& input,
+                                          std::vector<std::complex<float>>& output) {
+    const int odd_taps = static_cast<int>(stage.taps.size());
+    const int length = odd_taps * 4 - 1;
+    const int centre_offset = length / 2;
+    const float* taps = stage.taps.data();
+
+    // History holds the previous length - 1 inputs; append the new block behind it
+    std::vector<std::complex<float>>& buffer = stage.history;
+    size_t start = buffer.size();
+    buffer.insert(buffer.end(), input.begin(), input.end());
+    output.reserve(output.size() + input.size() / 2 + 1);
+
+    for (size_t j = start; j < buffer.size(); ++j) {
+        stage.odd_phase = !stage.odd_phase;
+        if (!stage.odd_phase) continue;  // Emit on every other input
+
+        // Window ends at the newest sample j; symmetric taps around its centre
+        const std::complex<float>* centre = &buffer[j - centre_offset];
+        float re = 0.5f * centre->real();
+        float im = 0.5f * centre->imag();
+        for (int k = 0; k < odd_taps; ++k) {
+            int n = 2 * k + 1;
+            re += taps[k] * (centre[-n].real() + centre[n].real());
+            im += taps[k] * (centre[-n].imag() + centre[n].imag());
+        }
+        output.emplace_back(re, im);
+    }
+
+    // Keep the last length - 1 samples for the next call
+    buffer.erase(buffer.begin(), buffer.end() - (length - 1));
+}
@@ -0,0 +1,66 @@
+#ifndef MULTISTAGE_DECIMATOR_H
+#define MULTISTAGE_DECIMATOR_H
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+// Power-of-two decimating front end for DynamicBandpassFilter.
+// Large factors start with a 4th-order CIC (integer arithmetic, wraps safely), and the
+// last two octaves are always half-band FIR stages that remove the CIC's aliasing. The
+// half-bands do not flatten the CIC droop; passbandMagnitude() reports the cascade's
+// response so the bandpass kernel can compensate it.
+// Not thread-safe - owned by the processing thread.
+class MultistageDecimator {
+public:
+    MultistageDecimator();
+
+    // Plan stages for a total factor (rounded down to a power of two, 1 = passthrough)
+    void configure(int decimation);
+    int getDecimation() const { return decimation_; }
+    int getCICFactor() const { return cic_factor_; }
+    int getHalfBandStages() const { return static_cast<int>(halfband_stages_.size()); }
+    void reset();
+
+    // Appends decimated samples to output; filter state carries across calls
+    void process(const std::complex<float>* input, size_t count, std::vector<std::complex<float>>& output);
+    // Writes at most capacity samples to output and returns the count; no allocation once warmed up
+    size_t process(const std::complex<float>* input, size_t count, std::complex<float>* output, size_t capacity);
+
+    // Largest power-of-two factor that keeps |max_frequency_hz| inside the output band
+    // with a guard for the final half-band transition
+    static int chooseDecimation(double sample_rate, double max_frequency_hz, int max_decimation = 4096);
+    // Cascade magnitude for configure(decimation) at k * bin_hz, k = 0..bins-1, in an output band
+    // sampled at output_rate
+    static void passbandMagnitude(int decimation, double output_rate, double bin_hz, int bins, float* magnitude);
+
+private:
+    struct CICStage {
+        int factor;
+        int phase;
+        uint64_t integrators[4][2];   // Modular arithmetic - overflow wraps and cancels in the combs
+        uint64_t comb_delays[4][2];
+    };
+
+    struct HalfBandStage {
+        std::vector<float> taps;                      // Odd-offset taps only; centre tap is 0.5
+        std::vector<std::complex<float>> history;     // Last (4 * taps.size() - 2) inputs
+        bool odd_phase;
+    };
+
+    const std::vector<std::complex<float>>& runStages(const std::complex<float>* input, size_t count);
+    void processCIC(const std::complex<float>* input, size_t count, std::vector<std::complex<float>>& output);
+    void processHalfBand(HalfBandStage& stage, const std::vector<std::complex<float>>& input,
+                         std::vector<std::complex<float>>& output);
+    static int planCICFactor(int factor);
+    static std::vector<float> designHalfBand(int odd_taps);
+
+    int decimation_;
+    int cic_factor_;
+    CICStage cic_;
+    std::vector<HalfBandStage> halfband_stages_;
+    std::vector<std::complex<float>> scratch_a_;
+    std::vector<std::complex<float>> scratch_b_;
+};
+
+#endif // MULTISTAGE_DECIMATOR_H
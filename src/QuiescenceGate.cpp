@@ -0,0 +1,38 @@
+#include "QuiescenceGate.h"
+
+QuiescenceGate::QuiescenceGate()
+    : active_(0)
+    , closers_(0)
+    , epoch_(0)
+{
+}
+
+bool QuiescenceGate::enter() {
+    active_.fetch_add(1);
+    if (closers_.load() > 0) {
+        leave();
+        return false;
+    }
+    return true;
+}
+
+void QuiescenceGate::leave() {
+    // Last one out wakes a waiting closer. Taking the mutex orders the notify after the
+    // closer's predicate check, so the wakeup cannot fall between check and wait.
+    if (active_.fetch_sub(1) == 1 && closers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drained_.notify_all();
+    }
+}
+
+void QuiescenceGate::close() {
+    closers_.fetch_add(1);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this]() { return active_.load() == 0; });
+    epoch_.fetch_add(1);
+}
+
+void QuiescenceGate::open() {
+    closers_.fetch_sub(1);
+}
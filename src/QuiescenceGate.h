@@ -0,0 +1,70 @@
+#ifndef QUIESCENCE_GATE_H
+#define QUIESCENCE_GATE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Reference count of calls inside a guarded region, plus a way for a reconfiguring
+// thread to shut the region and wait - without polling - until the last call leaves.
+// enter()/leave() are two atomic ops and never lock unless someone is waiting.
+// While the gate is closed enter() fails, so callers take their bypass path instead
+// of touching state that is being rebuilt. close() nests; the gate reopens when every
+// close() has been matched by open().
+class QuiescenceGate {
+public:
+    QuiescenceGate();
+
+    QuiescenceGate(const QuiescenceGate&) = delete;
+    QuiescenceGate& operator=(const QuiescenceGate&) = delete;
+
+    // Reader side. false = gate closed, do not call leave()
+    bool enter();
+    void leave();
+
+    // Writer side. close() returns once no call is inside; must not be called from one
+    void close();
+    void open();
+
+    bool isClosed() const { return closers_.load() > 0; }
+    int activeCount() const { return active_.load(); }
+    uint64_t epoch() const { return epoch_.load(); }     // Completed close() calls
+
+    // RAII reader: check with operator bool before using the guarded state
+    class ActiveScope {
+    public:
+        explicit ActiveScope(QuiescenceGate& gate) : gate_(gate), entered_(gate.enter()) {}
+        ~ActiveScope() { if (entered_) gate_.leave(); }
+        ActiveScope(const ActiveScope&) = delete;
+        ActiveScope& operator=(const ActiveScope&) = delete;
+        explicit operator bool() const { return entered_; }
+
+    private:
+        QuiescenceGate& gate_;
+        bool entered_;
+    };
+
+    // RAII writer: the region is empty and stays shut for the scope's lifetime
+    class ClosedScope {
+    public:
+        explicit ClosedScope(QuiescenceGate& gate) : gate_(gate) { gate_.close(); }
+        ~ClosedScope() { gate_.open(); }
+        ClosedScope(const ClosedScope&) = delete;
+        ClosedScope& operator=(const ClosedScope&) = delete;
+
+    private:
+        QuiescenceGate& gate_;
+    };
+
+private:
+    // Sequentially consistent on both sides: either a reader sees the gate closed, or
+    // the closer sees the reader's count and waits for its leave()
+    std::atomic<int> active_;
+    std::atomic<int> closers_;
+    std::atomic<uint64_t> epoch_;
+    std::mutex mutex_;
+    std::condition_variable drained_;
+};
+
+#endif // QUIESCENCE_GATE_H
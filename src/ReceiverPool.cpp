@@ -0,0 +1,374 @@
+#include "ReceiverPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <QDebug>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ReceiverPool::Stream::Stream(int stream_id, int worker_index, size_t depth, size_t block_samples)
+    : id(stream_id)
+    , worker(worker_index)
+    , input_pool(block_samples, depth)
+    , output_pool(block_samples, depth)
+    , queue(depth)
+    , queue_head(0)
+    , queue_count(0)
+    , samples_submitted(0)
+    , samples_processed(0)
+    , samples_bypassed(0)
+    , blocks_processed(0)
+    , input_overruns(0)
+    , oversized_submits(0)
+    , output_overruns(0)
+    , processing_ns(0)
+    , queue_high_water(0)
+{
+}
+
+ReceiverPool::ReceiverPool(const PoolConfig& config)
+    : config_(config)
+    , next_worker_(0)
+    , running_(false)
+    , start_time_ns_(0)
+{
+    int workers = config_.worker_count;
+    if (workers <= 0) {
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    config_.queue_depth = std::max<size_t>(config_.queue_depth, 1);
+    config_.max_block_samples = std::max<size_t>(config_.max_block_samples, 1);
+
+    for (int i = 0; i < workers; ++i) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->index = i;
+        workers_.push_back(std::move(worker));
+    }
+
+    qDebug() << "ReceiverPool: Created with" << workers << "workers, queue depth" << config_.queue_depth;
+}
+
+ReceiverPool::~ReceiverPool() {
+    stop();
+}
+
+int ReceiverPool::addStream(std::shared_ptr<DynamicBandpassFilter> filter, OutputCallback callback) {
+    if (!filter) return -1;
+
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    int id = static_cast<int>(streams_.size());
+    int worker_index = next_worker_.fetch_add(1) % static_cast<int>(workers_.size());
+
+    std::unique_ptr<Stream> stream(new Stream(id, worker_index, config_.queue_depth, config_.max_block_samples));
+    stream->filter = std::move(filter);
+    stream->callback = std::move(callback);
+
+    Worker* worker = workers_[worker_index].get();
+    {
+        std::lock_guard<std::mutex> worker_lock(worker->mutex);
+        worker->streams.push_back(stream.get());
+    }
+    streams_.push_back(std::move(stream));
+
+    qDebug() << "ReceiverPool: Stream" << id << "assigned to worker" << worker_index;
+    return id;
+}
+
+int ReceiverPool::getStreamCount() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return static_cast<int>(streams_.size());
+}
+
+void ReceiverPool::start() {
+    if (running_.exchange(true)) return;
+
+    start_time_ns_.store(nowNs());
+    for (auto& worker : workers_) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { workerLoop(w); });
+    }
+
+    qDebug() << "ReceiverPool: Started";
+}
+
+void ReceiverPool::stop() {
+    if (!running_.exchange(false)) return;
+
+    for (auto& worker : workers_) {
+        {
+            // Taking the lock orders the flag change before the worker's wait check
+            std::lock_guard<std::mutex> lock(worker->mutex);
+        }
+        worker->wake.notify_all();
+    }
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (Stream* stream : worker->streams) {
+            for (auto& block : stream->queue) {
+                block.release();
+            }
+            stream->queue_head = 0;
+            stream->queue_count = 0;
+        }
+        worker->pending = 0;
+    }
+
+    qDebug() << "ReceiverPool: Stopped";
+}
+
+bool ReceiverPool::submit(int stream_id, const std::complex<float>* samples, size_t count) {
+    if (!samples || count == 0) return false;
+
+    Stream* stream = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        if (stream_id < 0 || stream_id >= static_cast<int>(streams_.size())) return false;
+        stream = streams_[stream_id].get();
+    }
+
+    stream->samples_submitted.fetch_add(count, std::memory_order_relaxed);
+
+    if (count > stream->input_pool.blockCapacity()) {
+        // A caller bug rather than load: say so once per stream instead of hiding it in the overruns
+        if (stream->oversized_submits.fetch_add(1, std::memory_order_relaxed) == 0) {
+            qDebug() << "ReceiverPool: Stream" << stream_id << "submitted" << count
+                     << "samples, over max_block_samples" << stream->input_pool.blockCapacity() << "- rejected";
+        }
+        return false;
+    }
+    if (!running_.load()) {
+        stream->input_overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Copy outside the worker lock; the pool has exactly queue_depth blocks
+    SampleBlockPool::Block block = stream->input_pool.acquire();
+    if (!block) {
+        stream->input_overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    std::copy(samples, samples + count, block.data());
+    block.resize(count);
+
+    Worker* worker = workers_[stream->worker].get();
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        size_t depth = stream->queue.size();
+        if (stream->queue_count >= depth) {
+            stream->input_overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        stream->queue[(stream->queue_head + stream->queue_count) % depth] = std::move(block);
+        ++stream->queue_count;
+        ++worker->pending;
+
+        if (stream->queue_count > stream->queue_high_water.load(std::memory_order_relaxed)) {
+            stream->queue_high_water.store(stream->queue_count, std::memory_order_relaxed);
+        }
+    }
+    worker->wake.notify_one();
+    return true;
+}
+
+void ReceiverPool::workerLoop(Worker* worker) {
+    applyThreadPolicy(worker);
+
+    size_t cursor = 0;
+    while (true) {
+        Stream* stream = nullptr;
+        SampleBlockPool::Block input;
+        {
+            std::unique_lock<std::mutex> lock(worker->mutex);
+            worker->wake.wait(lock, [&]() { return !running_.load() || worker->pending > 0; });
+            if (!running_.load()) break;
+
+            // Round-robin so one busy stream cannot starve the others on this worker
+            size_t stream_count = worker->streams.size();
+            for (size_t n = 0; n < stream_count; ++n) {
+                Stream* candidate = worker->streams[(cursor + n) % stream_count];
+                if (candidate->queue_count == 0) continue;
+
+                stream = candidate;
+                cursor = (cursor + n + 1) % stream_count;
+                input = std::move(stream->queue[stream->queue_head]);
+                stream->queue_head = (stream->queue_head + 1) % stream->queue.size();
+                --stream->queue_count;
+                --worker->pending;
+                break;
+            }
+        }
+
+        if (!stream) continue;
+
+        uint64_t begin_ns = nowNs();
+        size_t count = input.size();
+        // Only this worker drives the filter, so the bypass counter moves for this block alone
+        uint64_t bypassed_before = stream->filter->getSamplesBypassed();
+        SampleBlockPool::Block output = stream->filter->process(input.data(), count, stream->output_pool);
+        input.release();
+        uint64_t filtered_ns = nowNs();
+        bool bypassed = stream->filter->getSamplesBypassed() != bypassed_before;
+
+        stream->blocks_processed.fetch_add(1, std::memory_order_relaxed);
+
+        if (!output) {
+            stream->output_overruns.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // A bypassed block costs a copy, not a filter pass; keep it out of the cost per sample
+            if (bypassed) {
+                stream->samples_bypassed.fetch_add(count, std::memory_order_relaxed);
+            } else {
+                stream->processing_ns.fetch_add(filtered_ns - begin_ns, std::memory_order_relaxed);
+                stream->samples_processed.fetch_add(count, std::memory_order_relaxed);
+            }
+            if (stream->callback) {
+                stream->callback(stream->id, std::move(output));
+            }
+        }
+
+        worker->busy_ns.fetch_add(nowNs() - begin_ns, std::memory_order_relaxed);
+    }
+}
+
+void ReceiverPool::applyThreadPolicy(Worker* worker) {
+    int cpu = -1;
+    if (worker->index < static_cast<int>(config_.cpu_affinity.size())) {
+        cpu = config_.cpu_affinity[worker->index];
+    }
+
+#if defined(_WIN32)
+    if (cpu >= 0 && cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        if (SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) == 0) {
+            qDebug() << "ReceiverPool: Worker" << worker->index << "could not be pinned to CPU" << cpu;
+        }
+    }
+    if (config_.realtime_priority) {
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+            qDebug() << "ReceiverPool: Worker" << worker->index << "could not raise priority";
+        }
+    }
+#elif defined(__linux__)
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+            qDebug() << "ReceiverPool: Worker" << worker->index << "could not be pinned to CPU" << cpu;
+        }
+    }
+    if (config_.realtime_priority) {
+        sched_param param;
+        param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+                                        std::min(config_.realtime_priority_level, sched_get_priority_max(SCHED_FIFO)));
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+            // Usually missing CAP_SYS_NICE / rtprio limits - keep running at normal priority
+            qDebug() << "ReceiverPool: Worker" << worker->index << "could not switch to SCHED_FIFO";
+        }
+    }
+#else
+    if (cpu >= 0 || config_.realtime_priority) {
+        qDebug() << "ReceiverPool: CPU affinity and real-time priority not supported on this platform";
+    }
+#endif
+}
+
+ReceiverPool::PoolStats ReceiverPool::getStats() const {
+    PoolStats stats;
+    stats.total_samples_processed = 0;
+    stats.total_overruns = 0;
+    stats.aggregate_throughput_msps = 0.0;
+    stats.processing_ns_per_sample = 0.0;
+
+    uint64_t start_ns = start_time_ns_.load();
+    stats.uptime_s = (start_ns != 0) ? (nowNs() - start_ns) * 1e-9 : 0.0;
+
+    uint64_t total_processing_ns = 0;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        stats.streams.reserve(streams_.size());
+        for (const auto& stream : streams_) {
+            StreamStats s;
+            s.stream_id = stream->id;
+            s.worker = stream->worker;
+            s.samples_submitted = stream->samples_submitted.load(std::memory_order_relaxed);
+            s.samples_processed = stream->samples_processed.load(std::memory_order_relaxed);
+            s.samples_bypassed = stream->samples_bypassed.load(std::memory_order_relaxed);
+            s.blocks_processed = stream->blocks_processed.load(std::memory_order_relaxed);
+            s.input_overruns = stream->input_overruns.load(std::memory_order_relaxed);
+            s.oversized_submits = stream->oversized_submits.load(std::memory_order_relaxed);
+            s.output_overruns = stream->output_overruns.load(std::memory_order_relaxed);
+            s.queue_high_water = stream->queue_high_water.load(std::memory_order_relaxed);
+
+            uint64_t processing_ns = stream->processing_ns.load(std::memory_order_relaxed);
+            s.processing_ns_per_sample = (s.samples_processed > 0)
+                ? static_cast<double>(processing_ns) / s.samples_processed : 0.0;
+            s.throughput_msps = (stats.uptime_s > 0.0) ? s.samples_processed / stats.uptime_s / 1e6 : 0.0;
+
+            stats.total_samples_processed += s.samples_processed;
+            stats.total_overruns += s.input_overruns + s.output_overruns;
+            stats.aggregate_throughput_msps += s.throughput_msps;
+            total_processing_ns += processing_ns;
+            stats.streams.push_back(s);
+        }
+    }
+
+    if (stats.total_samples_processed > 0) {
+        stats.processing_ns_per_sample = static_cast<double>(total_processing_ns) / stats.total_samples_processed;
+    }
+
+    stats.worker_utilization.reserve(workers_.size());
+    for (const auto& worker : workers_) {
+        double busy_s = worker->busy_ns.load(std::memory_order_relaxed) * 1e-9;
+        stats.worker_utilization.push_back(stats.uptime_s > 0.0 ? std::min(1.0, busy_s / stats.uptime_s) : 0.0);
+    }
+
+    return stats;
+}
+
+void ReceiverPool::resetStats() {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    for (auto& stream : streams_) {
+        stream->samples_submitted.store(0);
+        stream->samples_processed.store(0);
+        stream->samples_bypassed.store(0);
+        stream->blocks_processed.store(0);
+        stream->input_overruns.store(0);
+        stream->oversized_submits.store(0);
+        stream->output_overruns.store(0);
+        stream->processing_ns.store(0);
+        stream->queue_high_water.store(0);
+    }
+    for (auto& worker : workers_) {
+        worker->busy_ns.store(0);
+    }
+    start_time_ns_.store(running_.load() ? nowNs() : 0);
+}
+
+int ReceiverPool::estimateSustainableStreams(double sample_rate, double headroom) const {
+    if (sample_rate <= 0.0) return 0;
+
+    PoolStats stats = getStats();
+    if (stats.processing_ns_per_sample <= 0.0) return 0;   // Nothing measured yet
+
+    // Streams are pinned to one worker, so capacity is whole streams per worker
+    double usable = std::max(0.0, std::min(1.0, 1.0 - headroom));
+    double samples_per_worker = usable * 1e9 / stats.processing_ns_per_sample;
+    int per_worker = static_cast<int>(std::floor(samples_per_worker / sample_rate));
+    return per_worker * static_cast<int>(workers_.size());
+}
+
+uint64_t ReceiverPool::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
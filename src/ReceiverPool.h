@@ -0,0 +1,144 @@
+#ifndef RECEIVER_POOL_H
+#define RECEIVER_POOL_H
+
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DynamicBandpassFilter.h"
+#include "SampleBlockPool.h"
+
+// Runs many independent IQ streams (one DynamicBandpassFilter each) on a fixed set of
+// worker threads. Each stream is pinned to one worker so its blocks stay in order and
+// its filter is only ever touched by one thread. submit() copies into a pooled block
+// and never blocks; a full queue is counted as an overrun and the block is dropped.
+class ReceiverPool {
+public:
+    struct PoolConfig {
+        int worker_count;                 // 0 = hardware concurrency
+        std::vector<int> cpu_affinity;    // CPU per worker, -1 or missing = unpinned
+        bool realtime_priority;           // SCHED_FIFO / TIME_CRITICAL; falls back silently
+        int realtime_priority_level;      // SCHED_FIFO priority (1-99) on POSIX
+        size_t queue_depth;               // Blocks buffered per stream before overrun
+        size_t max_block_samples;         // Largest submit() size per stream; larger ones are rejected
+
+        PoolConfig()
+            : worker_count(0)
+            , realtime_priority(false)
+            , realtime_priority_level(50)
+            , queue_depth(8)
+            , max_block_samples(65536)
+        {}
+    };
+
+    // Output blocks are pooled; keep them only as long as needed
+    typedef std::function<void(int stream_id, SampleBlockPool::Block&& output)> OutputCallback;
+
+    struct StreamStats {
+        int stream_id;
+        int worker;
+        uint64_t samples_submitted;
+        uint64_t samples_processed;       // Filtered samples only
+        uint64_t samples_bypassed;        // Returned unfiltered by the filter, not in the cost figures
+        uint64_t blocks_processed;
+        uint64_t input_overruns;          // Dropped at submit(): queue or input pool full
+        uint64_t oversized_submits;       // Rejected at submit(): over max_block_samples
+        uint64_t output_overruns;         // Dropped after filtering: output pool exhausted
+        size_t queue_high_water;
+        double processing_ns_per_sample;
+        double throughput_msps;           // Processed samples over pool uptime
+    };
+
+    struct PoolStats {
+        std::vector<StreamStats> streams;
+        std::vector<double> worker_utilization;   // Busy fraction since start()
+        uint64_t total_samples_processed;
+        uint64_t total_overruns;
+        double aggregate_throughput_msps;
+        double processing_ns_per_sample;          // Mean over all streams
+        double uptime_s;
+    };
+
+    explicit ReceiverPool(const PoolConfig& config = PoolConfig());
+    ~ReceiverPool();
+
+    // Streams can be added before or after start(); returns the stream id
+    int addStream(std::shared_ptr<DynamicBandpassFilter> filter, OutputCallback callback);
+    int getStreamCount() const;
+    int getWorkerCount() const { return static_cast<int>(workers_.size()); }
+
+    void start();
+    void stop();                          // Drains nothing - queued blocks are discarded
+    bool isRunning() const { return running_.load(); }
+
+    // Copies count samples into the stream's queue. False on overrun, on a block larger than
+    // max_block_samples, or on a bad stream id.
+    bool submit(int stream_id, const std::complex<float>* samples, size_t count);
+
+    PoolStats getStats() const;
+    void resetStats();
+
+    // How many streams at sample_rate the workers can sustain at the measured cost per
+    // sample, keeping headroom (0..1) spare on every worker
+    int estimateSustainableStreams(double sample_rate, double headroom = 0.2) const;
+
+private:
+    struct Stream {
+        int id;
+        int worker;
+        std::shared_ptr<DynamicBandpassFilter> filter;
+        OutputCallback callback;
+        SampleBlockPool input_pool;
+        SampleBlockPool output_pool;
+
+        // Ring of queued input blocks, guarded by the owning worker's mutex
+        std::vector<SampleBlockPool::Block> queue;
+        size_t queue_head;
+        size_t queue_count;
+
+        std::atomic<uint64_t> samples_submitted;
+        std::atomic<uint64_t> samples_processed;
+        std::atomic<uint64_t> samples_bypassed;
+        std::atomic<uint64_t> blocks_processed;
+        std::atomic<uint64_t> input_overruns;
+        std::atomic<uint64_t> oversized_submits;
+        std::atomic<uint64_t> output_overruns;
+        std::atomic<uint64_t> processing_ns;
+        std::atomic<size_t> queue_high_water;
+
+        Stream(int stream_id, int worker_index, size_t depth, size_t block_samples);
+    };
+
+    struct Worker {
+        int index;
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<Stream*> streams;
+        size_t pending;                   // Queued blocks across this worker's streams
+        std::atomic<uint64_t> busy_ns;
+
+        Worker() : index(0), pending(0), busy_ns(0) {}
+    };
+
+    void workerLoop(Worker* worker);
+    void applyThreadPolicy(Worker* worker);
+    static uint64_t nowNs();
+
+    PoolConfig config_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex streams_mutex_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::atomic<int> next_worker_;
+
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> start_time_ns_;
+};
+
+#endif // RECEIVER_POOL_H
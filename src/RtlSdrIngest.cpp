@@ -0,0 +1,183 @@
+#include "RtlSdrIngest.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <QDebug>
+
+#ifdef HAVE_RTLSDR
+#include <rtl-sdr.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Fake driver fills released buffers with this so stale pointers are obvious
+static const uint8_t FAKE_DRIVER_POISON = 0xA5;
+
+#ifdef HAVE_RTLSDR
+RtlSdrDriver::RtlSdrDriver(rtlsdr_dev* device)
+    : device_(device)
+{
+}
+
+int RtlSdrDriver::read(ReadCallback callback, void* context, uint32_t buffer_count, uint32_t buffer_length) {
+    if (!device_) return -1;
+    rtlsdr_reset_buffer(device_);
+    return rtlsdr_read_async(device_, callback, context, buffer_count, buffer_length);
+}
+
+int RtlSdrDriver::cancel() {
+    return device_ ? rtlsdr_cancel_async(device_) : -1;
+}
+
+uint32_t RtlSdrDriver::getSampleRate() const {
+    return device_ ? rtlsdr_get_sample_rate(device_) : 0;
+}
+#endif
+
+FakeRtlSdrDriver::FakeRtlSdrDriver(uint32_t sample_rate, float tone_offset_hz, float tone_amplitude,
+                                   float noise_amplitude)
+    : sample_rate_(sample_rate)
+    , tone_offset_hz_(tone_offset_hz)
+    , tone_amplitude_(tone_amplitude)
+    , noise_amplitude_(noise_amplitude)
+    , cancelled_(false)
+    , paced_(true)
+    , buffers_delivered_(0)
+{
+}
+
+int FakeRtlSdrDriver::read(ReadCallback callback, void* context, uint32_t buffer_count, uint32_t buffer_length) {
+    if (!callback || sample_rate_ == 0) return -1;
+
+    buffer_count = std::max<uint32_t>(buffer_count, 1);
+    buffer_length = std::max<uint32_t>(buffer_length & ~1u, 2);   // Whole I/Q pairs
+    std::vector<std::vector<uint8_t>> buffers(buffer_count, std::vector<uint8_t>(buffer_length, FAKE_DRIVER_POISON));
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    double phase = 0.0;
+    double phase_step = 2.0 * M_PI * tone_offset_hz_ / sample_rate_;
+    uint32_t samples_per_buffer = buffer_length / 2;
+    auto buffer_period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 * samples_per_buffer / sample_rate_));
+    auto deadline = std::chrono::steady_clock::now();
+
+    for (uint32_t index = 0; !cancelled_.load(); index = (index + 1) % buffer_count) {
+        std::vector<uint8_t>& buffer = buffers[index];
+        for (uint32_t i = 0; i < samples_per_buffer; ++i) {
+            float re = tone_amplitude_ * static_cast<float>(std::cos(phase)) + noise_amplitude_ * noise(rng);
+            float im = tone_amplitude_ * static_cast<float>(std::sin(phase)) + noise_amplitude_ * noise(rng);
+            buffer[2 * i] = static_cast<uint8_t>(std::clamp(std::lround(re * 127.5f + 127.5f), 0L, 255L));
+            buffer[2 * i + 1] = static_cast<uint8_t>(std::clamp(std::lround(im * 127.5f + 127.5f), 0L, 255L));
+            phase = std::fmod(phase + phase_step, 2.0 * M_PI);
+        }
+
+        // Hardware delivers at the sample rate; a slow consumer just falls behind the deadline
+        if (paced_.load()) {
+            deadline += buffer_period;
+            std::this_thread::sleep_until(deadline);
+        }
+
+        callback(buffer.data(), buffer_length, context);
+        buffers_delivered_.fetch_add(1);
+
+        // Back in driver hands - the consumer must not be looking at it any more
+        std::memset(buffer.data(), FAKE_DRIVER_POISON, buffer.size());
+    }
+
+    // A cancel() that arrives before read() starts still stops it; re-arm on the way out
+    cancelled_.store(false);
+    return 0;
+}
+
+int FakeRtlSdrDriver::cancel() {
+    cancelled_.store(true);
+    return 0;
+}
+
+RtlSdrIngest::RtlSdrIngest(std::shared_ptr<IQDriver> driver, std::shared_ptr<DynamicBandpassFilter> filter,
+                           BlockSink sink, uint32_t buffer_count, uint32_t buffer_length, size_t output_blocks)
+    : driver_(std::move(driver))
+    , filter_(std::move(filter))
+    , sink_(std::move(sink))
+    , buffer_count_(buffer_count)
+    , buffer_length_(buffer_length)
+    , output_pool_(buffer_length / 2, output_blocks)
+    , running_(false)
+    , buffers_(0)
+    , samples_in_(0)
+    , samples_out_(0)
+    , dropped_buffers_(0)
+    , max_callback_ns_(0)
+{
+}
+
+RtlSdrIngest::~RtlSdrIngest() {
+    stop();
+}
+
+void RtlSdrIngest::start() {
+    if (!driver_ || !filter_ || running_.exchange(true)) return;
+
+    reader_ = std::thread([this]() {
+        int result = driver_->read(&RtlSdrIngest::driverCallback, this, buffer_count_, buffer_length_);
+        if (result != 0) {
+            qDebug() << "RtlSdrIngest: Driver read ended with" << result;
+        }
+    });
+
+    qDebug() << "RtlSdrIngest: Started -" << buffer_count_ << "buffers of" << buffer_length_ << "bytes";
+}
+
+void RtlSdrIngest::stop() {
+    if (!running_.exchange(false)) return;
+
+    driver_->cancel();
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+
+    qDebug() << "RtlSdrIngest: Stopped after" << buffers_.load() << "buffers";
+}
+
+void RtlSdrIngest::driverCallback(unsigned char* buffer, uint32_t length, void* context) {
+    static_cast<RtlSdrIngest*>(context)->handleBuffer(buffer, length);
+}
+
+void RtlSdrIngest::handleBuffer(const uint8_t* buffer, uint32_t length) {
+    // Runs on the driver thread while it holds the buffer - nothing may keep the pointer
+    auto start = std::chrono::steady_clock::now();
+    buffers_.fetch_add(1, std::memory_order_relaxed);
+    samples_in_.fetch_add(length / 2, std::memory_order_relaxed);
+
+    SampleBlockPool::Block block = filter_->processCU8(buffer, length, output_pool_);
+
+    uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    uint64_t worst = max_callback_ns_.load(std::memory_order_relaxed);
+    while (elapsed > worst && !max_callback_ns_.compare_exchange_weak(worst, elapsed, std::memory_order_relaxed)) {
+    }
+
+    if (!block) {
+        dropped_buffers_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    samples_out_.fetch_add(block.size(), std::memory_order_relaxed);
+    if (sink_) {
+        sink_(std::move(block));
+    }
+}
+
+RtlSdrIngest::IngestStats RtlSdrIngest::getStats() const {
+    IngestStats stats;
+    stats.buffers = buffers_.load();
+    stats.samples_in = samples_in_.load();
+    stats.samples_out = samples_out_.load();
+    stats.dropped_buffers = dropped_buffers_.load();
+    stats.max_callback_ms = max_callback_ns_.load() / 1e6;
+    return stats;
+}
@@ -0,0 +1,118 @@
+#ifndef RTLSDR_INGEST_H
+#define RTLSDR_INGEST_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "DynamicBandpassFilter.h"
+#include "SampleBlockPool.h"
+
+// Async IQ source with librtlsdr's calling convention. read() blocks the calling thread
+// and invokes the callback with driver-owned cu8 buffers until cancel() is called.
+// A buffer is valid only until the callback returns; the driver then reuses it.
+class IQDriver {
+public:
+    typedef void (*ReadCallback)(unsigned char* buffer, uint32_t length, void* context);
+
+    virtual ~IQDriver() = default;
+    virtual int read(ReadCallback callback, void* context, uint32_t buffer_count, uint32_t buffer_length) = 0;
+    virtual int cancel() = 0;
+    virtual uint32_t getSampleRate() const = 0;
+};
+
+#ifdef HAVE_RTLSDR
+struct rtlsdr_dev;
+
+// Thin wrapper over rtlsdr_read_async / rtlsdr_cancel_async on an already opened device
+class RtlSdrDriver : public IQDriver {
+public:
+    explicit RtlSdrDriver(rtlsdr_dev* device);
+    int read(ReadCallback callback, void* context, uint32_t buffer_count, uint32_t buffer_length) override;
+    int cancel() override;
+    uint32_t getSampleRate() const override;
+
+private:
+    rtlsdr_dev* device_;
+};
+#endif
+
+// Local stand-in for librtlsdr: synthesizes cu8 buffers (tone + noise, 8-bit quantized)
+// at a paced sample rate, rotating through buffer_count driver-owned buffers. After each
+// callback the buffer is scribbled over, so a consumer that keeps the pointer sees garbage.
+class FakeRtlSdrDriver : public IQDriver {
+public:
+    FakeRtlSdrDriver(uint32_t sample_rate, float tone_offset_hz = 0.0f, float tone_amplitude = 0.5f,
+                     float noise_amplitude = 0.01f);
+
+    int read(ReadCallback callback, void* context, uint32_t buffer_count, uint32_t buffer_length) override;
+    int cancel() override;
+    uint32_t getSampleRate() const override { return sample_rate_; }
+
+    void setRealTimePacing(bool enabled) { paced_.store(enabled); }   // Off = as fast as possible
+    uint64_t getBuffersDelivered() const { return buffers_delivered_.load(); }
+
+private:
+    uint32_t sample_rate_;
+    float tone_offset_hz_;
+    float tone_amplitude_;
+    float noise_amplitude_;
+    std::atomic<bool> cancelled_;
+    std::atomic<bool> paced_;
+    std::atomic<uint64_t> buffers_delivered_;
+};
+
+// Filters straight out of the driver callback. Each buffer is converted and filtered into
+// a pooled output block before the callback returns, so no driver memory is retained.
+// Output blocks go to the sink on the driver thread; they return to the pool when released.
+class RtlSdrIngest {
+public:
+    typedef std::function<void(SampleBlockPool::Block&& block)> BlockSink;
+
+    struct IngestStats {
+        uint64_t buffers;
+        uint64_t samples_in;
+        uint64_t samples_out;
+        uint64_t dropped_buffers;       // Output pool exhausted or buffer larger than a block
+        double max_callback_ms;         // Worst time spent holding a driver buffer
+    };
+
+    // buffer_length is in bytes (2 per sample), as for rtlsdr_read_async
+    RtlSdrIngest(std::shared_ptr<IQDriver> driver, std::shared_ptr<DynamicBandpassFilter> filter,
+                 BlockSink sink, uint32_t buffer_count = 15, uint32_t buffer_length = 16 * 16384,
+                 size_t output_blocks = 8);
+    ~RtlSdrIngest();
+
+    RtlSdrIngest(const RtlSdrIngest&) = delete;
+    RtlSdrIngest& operator=(const RtlSdrIngest&) = delete;
+
+    void start();                   // Runs the driver's blocking read on an owned thread
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    IngestStats getStats() const;
+
+private:
+    static void driverCallback(unsigned char* buffer, uint32_t length, void* context);
+    void handleBuffer(const uint8_t* buffer, uint32_t length);
+
+    std::shared_ptr<IQDriver> driver_;
+    std::shared_ptr<DynamicBandpassFilter> filter_;
+    BlockSink sink_;
+    uint32_t buffer_count_;
+    uint32_t buffer_length_;
+    SampleBlockPool output_pool_;
+
+    std::thread reader_;
+    std::atomic<bool> running_;
+
+    std::atomic<uint64_t> buffers_;
+    std::atomic<uint64_t> samples_in_;
+    std::atomic<uint64_t> samples_out_;
+    std::atomic<uint64_t> dropped_buffers_;
+    std::atomic<uint64_t> max_callback_ns_;
+};
+
+#endif // RTLSDR_INGEST_H
@@ -0,0 +1,116 @@
+#include "SampleBlockPool.h"
+#include <algorithm>
+#include <stdexcept>
+#include <fftw3.h>
+#include <QDebug>
+
+struct SampleBlockPool::Storage {
+    std::complex<float>* samples;
+    size_t block_capacity;
+    size_t block_count;
+    mutable std::mutex free_mutex;
+    std::vector<size_t> free_blocks;    // Reserved up front - push/pop never allocate
+
+    Storage(size_t capacity, size_t count)
+        : samples(nullptr)
+        , block_capacity(capacity)
+        , block_count(count)
+    {
+        // fftwf_malloc gives SIMD alignment for every block when capacity is a multiple of 8
+        samples = static_cast<std::complex<float>*>(fftwf_malloc(sizeof(std::complex<float>) * capacity * count));
+        if (!samples) {
+            throw std::runtime_error("Failed to allocate sample block pool");
+        }
+
+        free_blocks.reserve(count);
+        for (size_t i = count; i > 0; --i) {
+            free_blocks.push_back(i - 1);
+        }
+    }
+
+    ~Storage() {
+        fftwf_free(samples);
+    }
+
+    void release(size_t index) {
+        std::lock_guard<std::mutex> lock(free_mutex);
+        free_blocks.push_back(index);
+    }
+};
+
+SampleBlockPool::SampleBlockPool(size_t block_capacity, size_t block_count) {
+    // Round capacity up to whole cache lines (8 complex floats) so blocks stay aligned
+    size_t capacity = std::max<size_t>((block_capacity + 7) & ~static_cast<size_t>(7), 8);
+    storage_ = std::make_shared<Storage>(capacity, std::max<size_t>(block_count, 1));
+
+    qDebug() << "SampleBlockPool: Created" << storage_->block_count << "blocks of" << capacity << "samples";
+}
+
+SampleBlockPool::Block SampleBlockPool::acquire() {
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(storage_->free_mutex);
+        if (storage_->free_blocks.empty()) {
+            return Block();
+        }
+        index = storage_->free_blocks.back();
+        storage_->free_blocks.pop_back();
+    }
+    return Block(storage_, index);
+}
+
+size_t SampleBlockPool::blockCapacity() const {
+    return storage_->block_capacity;
+}
+
+size_t SampleBlockPool::blockCount() const {
+    return storage_->block_count;
+}
+
+size_t SampleBlockPool::available() const {
+    std::lock_guard<std::mutex> lock(storage_->free_mutex);
+    return storage_->free_blocks.size();
+}
+
+SampleBlockPool::Block::Block(Block&& other) noexcept
+    : storage_(std::move(other.storage_))
+    , index_(other.index_)
+    , size_(other.size_)
+{
+    other.size_ = 0;
+}
+
+SampleBlockPool::Block& SampleBlockPool::Block::operator=(Block&& other) noexcept {
+    if (this != &other) {
+        release();
+        storage_ = std::move(other.storage_);
+        index_ = other.index_;
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+std::complex<float>* SampleBlockPool::Block::data() {
+    return storage_ ? storage_->samples + index_ * storage_->block_capacity : nullptr;
+}
+
+const std::complex<float>* SampleBlockPool::Block::data() const {
+    return storage_ ? storage_->samples + index_ * storage_->block_capacity : nullptr;
+}
+
+size_t SampleBlockPool::Block::capacity() const {
+    return storage_ ? storage_->block_capacity : 0;
+}
+
+void SampleBlockPool::Block::resize(size_t size) {
+    size_ = std::min(size, capacity());
+}
+
+void SampleBlockPool::Block::release() {
+    if (storage_) {
+        storage_->release(index_);
+        storage_.reset();
+        size_ = 0;
+    }
+}
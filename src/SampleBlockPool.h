@@ -0,0 +1,66 @@
+#ifndef SAMPLE_BLOCK_POOL_H
+#define SAMPLE_BLOCK_POOL_H
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Fixed pool of aligned complex sample blocks. Blocks are handed out as move-only
+// handles that go back to the pool when destroyed, so steady-state processing makes
+// no heap allocations. Handles keep the pool storage alive, so they may outlive the pool.
+class SampleBlockPool {
+    struct Storage;
+
+public:
+    class Block {
+    public:
+        Block() : index_(0), size_(0) {}
+        ~Block() { release(); }
+
+        Block(Block&& other) noexcept;
+        Block& operator=(Block&& other) noexcept;
+        Block(const Block&) = delete;
+        Block& operator=(const Block&) = delete;
+
+        bool valid() const { return storage_ != nullptr; }
+        explicit operator bool() const { return valid(); }
+
+        std::complex<float>* data();
+        const std::complex<float>* data() const;
+        size_t size() const { return size_; }
+        size_t capacity() const;
+        void resize(size_t size);   // Clamped to capacity(); never reallocates
+
+        std::complex<float>* begin() { return data(); }
+        std::complex<float>* end() { return data() + size_; }
+        const std::complex<float>* begin() const { return data(); }
+        const std::complex<float>* end() const { return data() + size_; }
+
+        // Return the block to the pool early
+        void release();
+
+    private:
+        friend class SampleBlockPool;
+        Block(std::shared_ptr<Storage> storage, size_t index) : storage_(std::move(storage)), index_(index), size_(0) {}
+
+        std::shared_ptr<Storage> storage_;
+        size_t index_;
+        size_t size_;
+    };
+
+    SampleBlockPool(size_t block_capacity, size_t block_count);
+
+    // Empty handle when every block is in use
+    Block acquire();
+
+    size_t blockCapacity() const;
+    size_t blockCount() const;
+    size_t available() const;
+
+private:
+    std::shared_ptr<Storage> storage_;
+};
+
+#endif // SAMPLE_BLOCK_POOL_H
@@ -0,0 +1,102 @@
+#include "SpectralNoiseReducer.h"
+#include <algorithm>
+#include <cmath>
+#include <QDebug>
+
+// Noise floor tracking. Bins that look like noise (within NOISE_GATE_RATIO of the floor) are
+// averaged into it, which keeps it at the mean noise power; a minimum tracker would sit well
+// below the mean and let most noise bins through as signal. Louder bins may raise the floor
+// only by NOISE_RISE_RATE per frame, so a held signal is not learned as noise within seconds.
+static const float NOISE_TRACK_ALPHA = 0.05f;
+static const float NOISE_GATE_RATIO = 4.0f;
+static const float NOISE_RISE_RATE = 0.005f;
+static const int NOISE_TRAINING_FRAMES = 8;
+
+static const char* method_names[] = {"Spectral subtraction", "Noise gate", "Wiener"};
+
+SpectralNoiseReducer::SpectralNoiseReducer(Method method)
+    : method_(method)
+    , strength_(0.5f)
+    , gain_floor_(0.1f)
+    , frames_seen_(0)
+{
+    qDebug() << "SpectralNoiseReducer: Created -" << method_names[method];
+}
+
+void SpectralNoiseReducer::setStrength(float strength) {
+    strength_.store(std::clamp(strength, 0.0f, 1.0f));
+}
+
+void SpectralNoiseReducer::setGainFloor(float floor_db) {
+    gain_floor_.store(std::pow(10.0f, std::min(floor_db, 0.0f) / 20.0f));
+}
+
+void SpectralNoiseReducer::reset() {
+    noise_estimate_.clear();
+    previous_gain_.clear();
+    previous_power_.clear();
+    frames_seen_ = 0;
+}
+
+void SpectralNoiseReducer::computeGains(const fftwf_complex* spectrum, int fft_size, float* gains) {
+    if (noise_estimate_.size() != static_cast<size_t>(fft_size)) {
+        // New FFT size - restart noise training
+        noise_estimate_.assign(fft_size, 0.0f);
+        previous_gain_.assign(fft_size, 1.0f);
+        previous_power_.assign(fft_size, 0.0f);
+        frames_seen_ = 0;
+    }
+    
+    Method method = method_.load();
+    float strength = strength_.load();
+    float floor = gain_floor_.load();
+    bool training = frames_seen_ < NOISE_TRAINING_FRAMES;
+    
+    for (int i = 0; i < fft_size; ++i) {
+        float power = spectrum[i][0] * spectrum[i][0] + spectrum[i][1] * spectrum[i][1];
+        
+        // Track the noise floor (plain average while training)
+        float& noise = noise_estimate_[i];
+        if (training) {
+            noise += (power - noise) / (frames_seen_ + 1);
+        } else if (power < NOISE_GATE_RATIO * noise) {
+            noise += NOISE_TRACK_ALPHA * (power - noise);
+        } else {
+            noise *= 1.0f + NOISE_RISE_RATE;
+        }
+        
+        float gain = 1.0f;
+        if (!training && power > 0.0f && noise > 0.0f) {
+            float posteriori_snr = power / noise;
+            switch (method) {
+                case SPECTRAL_SUBTRACTION: {
+                    float over_subtraction = 1.0f + 3.0f * strength;
+                    gain = std::sqrt(std::max(1.0f - over_subtraction / posteriori_snr, 0.0f));
+                    break;
+                }
+                case NOISE_GATE:
+                    gain = (posteriori_snr > 2.0f + 8.0f * strength) ? 1.0f : 0.0f;
+                    break;
+                case WIENER:
+                default: {
+                    // Decision-directed a-priori SNR estimate
+                    float dd_alpha = 0.9f + 0.08f * strength;
+                    float previous_snr = previous_gain_[i] * previous_gain_[i] * previous_power_[i] / noise;
+                    float priori_snr = dd_alpha * previous_snr +
+                                       (1.0f - dd_alpha) * std::max(posteriori_snr - 1.0f, 0.0f);
+                    gain = priori_snr / (1.0f + priori_snr);
+                    break;
+                }
+            }
+            gain = std::max(gain, floor);
+        }
+        
+        previous_gain_[i] = gain;
+        previous_power_[i] = power;
+        gains[i] = gain;
+    }
+    
+    if (training) {
+        ++frames_seen_;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SPECTRAL_NOISE_REDUCER_H
+#define SPECTRAL_NOISE_REDUCER_H
+
+#include "DynamicBandpassFilter.h"
+#include <atomic>
+#include <vector>
+
+// Built-in noise reduction estimator for DynamicBandpassFilter::setNoiseReducer().
+// Tracks a per-bin noise floor and turns it into a gain mask, so noise reduction
+// shares the bandpass filter's forward/inverse FFT pair instead of running its own.
+class SpectralNoiseReducer : public DynamicBandpassFilter::NoiseReducer {
+public:
+    enum Method {
+        SPECTRAL_SUBTRACTION,
+        NOISE_GATE,
+        WIENER
+    };
+
+    explicit SpectralNoiseReducer(Method method = WIENER);
+
+    void setMethod(Method method) { method_.store(method); }
+    Method getMethod() const { return method_.load(); }
+    
+    // Strength 0..1 scales over-subtraction / gate threshold / a-priori SNR smoothing
+    void setStrength(float strength);
+    // Lowest gain applied to any bin, in dB (e.g. -20 keeps some residual noise)
+    void setGainFloor(float floor_db);
+
+    void computeGains(const fftwf_complex* spectrum, int fft_size, float* gains) override;
+    void reset() override;
+
+private:
+    std::atomic<Method> method_;
+    std::atomic<float> strength_;
+    std::atomic<float> gain_floor_;
+    
+    // Per-bin state, owned by the processing thread
+    std::vector<float> noise_estimate_;
+    std::vector<float> previous_gain_;
+    std::vector<float> previous_power_;
+    int frames_seen_;
+};
+
+#endif // SPECTRAL_NOISE_REDUCER_H
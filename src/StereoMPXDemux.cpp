@@ -0,0 +1,237 @@
+#include "StereoMPXDemux.h"
+#include "FFTBackend.h"
+#include "KaiserWindow.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <QDebug>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Broadcast FM multiplex layout
+static const double MPX_MONO_HIGH_HZ = 15000.0;
+static const double MPX_PILOT_HZ = 19000.0;
+static const double MPX_DIFFERENCE_LOW_HZ = 23000.0;
+static const double MPX_DIFFERENCE_HIGH_HZ = 53000.0;
+
+// FFT size is the smallest power of two at least this many times the kernel length
+static const int MPX_FFT_TO_TAPS = 4;
+
+// Windowed-sinc lowpass, cutoff in cycles per sample, accumulated into taps with a sign
+static void addLowpass(std::vector<double>& taps, const std::vector<double>& window, double cutoff, double sign) {
+    int length = static_cast<int>(taps.size());
+    double centre = 0.5 * (length - 1);
+    for (int n = 0; n < length; ++n) {
+        double t = n - centre;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        taps[n] += sign * sinc * window[n];
+    }
+}
+
+StereoMPXDemux::StereoMPXDemux(const MPXConfig& config)
+    : config_(config)
+    , tap_count_(0)
+    , fft_size_(0)
+    , hop_size_(0)
+    , spectrum_(nullptr)
+    , work_a_(nullptr)
+    , work_b_(nullptr)
+{
+    double half_transition = config_.transition_width_hz / 2.0;
+    if (config_.sample_rate / 2.0 <= MPX_DIFFERENCE_HIGH_HZ + config_.transition_width_hz ||
+        config_.transition_width_hz <= 0.0 || half_transition >= MPX_DIFFERENCE_LOW_HZ - MPX_PILOT_HZ) {
+        qDebug() << "StereoMPXDemux: Unsupported configuration - rate" << config_.sample_rate
+                 << "Hz, transition" << config_.transition_width_hz << "Hz";
+        return;
+    }
+
+    // Kaiser length estimate, odd so every kernel has an integer group delay
+    double delta = config_.transition_width_hz / config_.sample_rate;
+    tap_count_ = std::max(KaiserWindow::estimateLength(config_.stopband_attenuation_db, delta), 3);
+
+    fft_size_ = 256;
+    while (fft_size_ < MPX_FFT_TO_TAPS * tap_count_) {
+        fft_size_ *= 2;
+    }
+    hop_size_ = fft_size_ - (tap_count_ - 1);
+
+    backend_ = FFTBackendSelector::instance().createFastest(fft_size_);
+    spectrum_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size_);
+    work_a_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size_);
+    work_b_ = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fft_size_);
+    if (!backend_ || !spectrum_ || !work_a_ || !work_b_) {
+        qDebug() << "StereoMPXDemux: Failed to allocate" << fft_size_ << "bin engine";
+        backend_.reset();
+        return;
+    }
+
+    designKernels();
+    reset();
+
+    qDebug() << "StereoMPXDemux: Created -" << tap_count_ << "taps, FFT" << fft_size_ << "hop" << hop_size_
+             << "backend" << backend_->name() << "- cost vs 3 FIRs: 1 /" << getFIRCostRatio();
+}
+
+StereoMPXDemux::~StereoMPXDemux() {
+    if (spectrum_) fftwf_free(spectrum_);
+    if (work_a_) fftwf_free(work_a_);
+    if (work_b_) fftwf_free(work_b_);
+}
+
+void StereoMPXDemux::designKernels() {
+    std::vector<double> window(tap_count_);
+    KaiserWindow::fill(window.data(), tap_count_, KaiserWindow::beta(config_.stopband_attenuation_db));
+
+    // Cutoffs sit mid-transition, so each passband edge is the nominal band edge
+    double fs = config_.sample_rate;
+    double half_transition = config_.transition_width_hz / 2.0;
+    std::vector<double> mono(tap_count_, 0.0);
+    std::vector<double> pilot(tap_count_, 0.0);
+    std::vector<double> difference(tap_count_, 0.0);
+    addLowpass(mono, window, (MPX_MONO_HIGH_HZ + half_transition) / fs, 1.0);
+    addLowpass(pilot, window, (MPX_PILOT_HZ + half_transition) / fs, 1.0);
+    addLowpass(pilot, window, (MPX_PILOT_HZ - half_transition) / fs, -1.0);
+    addLowpass(difference, window, (MPX_DIFFERENCE_HIGH_HZ + half_transition) / fs, 1.0);
+    addLowpass(difference, window, (MPX_DIFFERENCE_LOW_HZ - half_transition) / fs, -1.0);
+
+    // The pilot band carries a single tone; normalize for exactly unity gain at 19 kHz
+    double pilot_re = 0.0;
+    double pilot_im = 0.0;
+    double centre = 0.5 * (tap_count_ - 1);
+    for (int n = 0; n < tap_count_; ++n) {
+        double phase = 2.0 * M_PI * MPX_PILOT_HZ / fs * (n - centre);
+        pilot_re += pilot[n] * std::cos(phase);
+        pilot_im += pilot[n] * std::sin(phase);
+    }
+    double pilot_gain = std::sqrt(pilot_re * pilot_re + pilot_im * pilot_im);
+    if (pilot_gain > 0.0) {
+        for (double& tap : pilot) tap /= pilot_gain;
+    }
+
+    // Frequency responses of the zero-padded taps, with the inverse FFT's 1/N folded in
+    auto response = [&](const std::vector<double>& taps, std::vector<std::complex<float>>& out) {
+        std::memset(work_a_, 0, sizeof(fftwf_complex) * fft_size_);
+        for (int n = 0; n < tap_count_; ++n) {
+            work_a_[n][0] = static_cast<float>(taps[n]);
+        }
+        backend_->forward(work_a_, work_a_);
+        out.resize(fft_size_);
+        float scale = 1.0f / fft_size_;
+        for (int k = 0; k < fft_size_; ++k) {
+            out[k] = std::complex<float>(work_a_[k][0], work_a_[k][1]) * scale;
+        }
+    };
+
+    std::vector<std::complex<float>> mono_response;
+    std::vector<std::complex<float>> pilot_response;
+    response(mono, mono_response);
+    response(pilot, pilot_response);
+    response(difference, difference_kernel_);
+
+    // Both responses belong to real filters, so one complex product carries both outputs
+    mono_pilot_kernel_.resize(fft_size_);
+    const std::complex<float> j(0.0f, 1.0f);
+    for (int k = 0; k < fft_size_; ++k) {
+        mono_pilot_kernel_[k] = mono_response[k] + j * pilot_response[k];
+    }
+}
+
+void StereoMPXDemux::reset() {
+    pending_.assign(tap_count_ > 0 ? tap_count_ - 1 : 0, 0.0f);
+}
+
+const char* StereoMPXDemux::getFFTBackendName() const {
+    return backend_ ? backend_->name() : FFTBackend::kindName(FFTBackend::KIND_COUNT);
+}
+
+double StereoMPXDemux::getFIRCostRatio() const {
+    if (!isValid()) return 0.0;
+
+    // Direct: three real FIRs, one multiply per tap per sample
+    double direct = 3.0 * tap_count_;
+
+    // This pass, per block pair: four radix-2 transforms (2 N log2 N real multiplies each)
+    // plus three complex spectrum products (4 real multiplies per bin each)
+    double log2_n = std::log2(static_cast<double>(fft_size_));
+    double per_pair = 4.0 * 2.0 * fft_size_ * log2_n + 3.0 * 4.0 * fft_size_;
+    return direct / (per_pair / (2.0 * hop_size_));
+}
+
+size_t StereoMPXDemux::process(const float* mpx, size_t count, MPXChannels& output) {
+    if (!isValid() || !mpx || count == 0) return 0;
+
+    pending_.insert(pending_.end(), mpx, mpx + count);
+
+    // Overlap-save: each block is fft_size_ samples, advancing hop_size_ at a time
+    size_t produced = 0;
+    size_t pair_span = static_cast<size_t>(fft_size_) + hop_size_;
+    size_t offset = 0;
+    while (pending_.size() - offset >= pair_span) {
+        const float* block_a = pending_.data() + offset;
+        processBlockPair(block_a, block_a + hop_size_, output);
+        offset += 2 * static_cast<size_t>(hop_size_);
+        produced += 2 * static_cast<size_t>(hop_size_);
+    }
+    if (offset > 0) {
+        pending_.erase(pending_.begin(), pending_.begin() + offset);
+    }
+    return produced;
+}
+
+void StereoMPXDemux::processBlockPair(const float* block_a, const float* block_b, MPXChannels& output) {
+    const int n = fft_size_;
+    const int hop = hop_size_;
+    const int valid_start = tap_count_ - 1;
+
+    // z = a + j b -> Z; each block's spectrum is the (anti-)Hermitian half of Z
+    for (int i = 0; i < n; ++i) {
+        spectrum_[i][0] = block_a[i];
+        spectrum_[i][1] = block_b[i];
+    }
+    backend_->forward(spectrum_, spectrum_);
+
+    size_t base = output.mono.size();
+    output.mono.resize(base + 2 * hop);
+    output.pilot.resize(base + 2 * hop);
+    output.difference.resize(base + 2 * hop);
+
+    // L-R of both blocks at once: both outputs are real, so H_diff (A + jB) = H_diff Z
+    // carries block a in the real part and block b in the imaginary part
+    for (int k = 0; k < n; ++k) {
+        const std::complex<float>& h = difference_kernel_[k];
+        float zr = spectrum_[k][0];
+        float zi = spectrum_[k][1];
+        work_b_[k][0] = zr * h.real() - zi * h.imag();
+        work_b_[k][1] = zr * h.imag() + zi * h.real();
+    }
+    backend_->inverse(work_b_, work_b_);
+    for (int i = 0; i < hop; ++i) {
+        output.difference[base + i] = work_b_[valid_start + i][0];
+        output.difference[base + hop + i] = work_b_[valid_start + i][1];
+    }
+
+    // Mono and pilot of one block at a time: X (H_mono + j H_pilot)
+    for (int block = 0; block < 2; ++block) {
+        for (int k = 0; k < n; ++k) {
+            std::complex<float> z(spectrum_[k][0], spectrum_[k][1]);
+            int mirror = (n - k) & (n - 1);
+            std::complex<float> z_mirror(spectrum_[mirror][0], -spectrum_[mirror][1]);
+            // A = (Z + conj Z[-k]) / 2, B = (Z - conj Z[-k]) / 2j
+            std::complex<float> x = (block == 0)
+                ? 0.5f * (z + z_mirror)
+                : std::complex<float>(0.0f, -0.5f) * (z - z_mirror);
+            const std::complex<float>& g = mono_pilot_kernel_[k];
+            work_a_[k][0] = x.real() * g.real() - x.imag() * g.imag();
+            work_a_[k][1] = x.real() * g.imag() + x.imag() * g.real();
+        }
+        backend_->inverse(work_a_, work_a_);
+
+        size_t out = base + block * hop;
+        for (int i = 0; i < hop; ++i) {
+            output.mono[out + i] = work_a_[valid_start + i][0];
+            output.pilot[out + i] = work_a_[valid_start + i][1];
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef STEREO_MPX_DEMUX_H
+#define STEREO_MPX_DEMUX_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+#include <fftw3.h>
+
+class FFTBackend;
+
+// WFM-MPX mode: splits the real FM discriminator output (the stereo multiplex) into
+// mono L+R (0-15 kHz), the 19 kHz pilot and the 38 kHz L-R DSB (23-53 kHz) in one
+// frequency-domain pass. The three kernels are Kaiser-windowed linear-phase FIRs of the
+// same length, so all outputs share one group delay and stay aligned for the matrix.
+//
+// Overlap-save, real input: two consecutive blocks ride in the real and imaginary parts
+// of one complex FFT, and the six real outputs come back from three inverse FFTs
+// (mono + pilot packed together, L-R of both blocks packed together). That is two
+// transforms per block instead of three complex filters, and far below three direct
+// FIRs at baseband rates - see getFIRCostRatio().
+class StereoMPXDemux {
+public:
+    struct MPXConfig {
+        double sample_rate;               // Discriminator output rate, at least ~120 kHz
+        double stopband_attenuation_db;
+        double transition_width_hz;       // Sets the tap count shared by all three kernels
+
+        MPXConfig()
+            : sample_rate(250000.0)
+            , stopband_attenuation_db(60.0)
+            , transition_width_hz(4000.0)
+        {}
+    };
+
+    // Appended to by process(); outputs are at the input rate
+    struct MPXChannels {
+        std::vector<float> mono;          // L+R
+        std::vector<float> pilot;         // 19 kHz tone, for the PLL / 38 kHz regeneration
+        std::vector<float> difference;    // (L-R) on the suppressed 38 kHz carrier
+
+        void clear() { mono.clear(); pilot.clear(); difference.clear(); }
+    };
+
+    explicit StereoMPXDemux(const MPXConfig& config = MPXConfig());
+    ~StereoMPXDemux();
+
+    StereoMPXDemux(const StereoMPXDemux&) = delete;
+    StereoMPXDemux& operator=(const StereoMPXDemux&) = delete;
+
+    bool isValid() const { return backend_ != nullptr; }
+
+    // Returns the number of samples appended to each channel (a multiple of the hop size;
+    // the rest waits in the input buffer for the next call)
+    size_t process(const float* mpx, size_t count, MPXChannels& output);
+    void reset();
+
+    int getTapCount() const { return tap_count_; }
+    int getFFTSize() const { return fft_size_; }
+    int getHopSize() const { return hop_size_; }
+    float getGroupDelaySamples() const { return 0.5f * (tap_count_ - 1); }
+    const char* getFFTBackendName() const;
+
+    // Estimated real multiplies per sample: three direct real FIRs over this pass
+    double getFIRCostRatio() const;
+
+private:
+    void designKernels();
+    void processBlockPair(const float* block_a, const float* block_b, MPXChannels& output);
+
+    MPXConfig config_;
+    int tap_count_;
+    int fft_size_;
+    int hop_size_;
+
+    std::unique_ptr<FFTBackend> backend_;
+    std::vector<std::complex<float>> mono_pilot_kernel_;   // H_mono + j H_pilot, scaled by 1/N
+    std::vector<std::complex<float>> difference_kernel_;   // H_diff, scaled by 1/N
+    fftwf_complex* spectrum_;
+    fftwf_complex* work_a_;
+    fftwf_complex* work_b_;
+
+    std::vector<float> pending_;        // tap_count_ - 1 samples of history, then new input
+};
+
+#endif // STEREO_MPX_DEMUX_H
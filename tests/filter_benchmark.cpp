@@ -0,0 +1,136 @@
+#include "DynamicBandpassFilter.h"
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Throughput per Protocol on multi-tone plus noise, compared with a baseline recorded on the
+// same machine. Timings do not carry between machines, so the baseline lives in the build
+// directory: the first run (or --record) writes it, later runs fail on a drop past the tolerance.
+//   filter_benchmark [--baseline <file>] [--record]
+
+struct BenchmarkCase {
+    DynamicBandpassFilter::Protocol protocol;
+    const char* name;
+    int sample_rate;
+    int fft_size;
+};
+
+static const BenchmarkCase CASES[] = {
+    {DynamicBandpassFilter::WFM, "WFM", 1024000, 4096},
+    {DynamicBandpassFilter::NBFM, "NBFM", 48000, 1024},
+    {DynamicBandpassFilter::AM, "AM", 48000, 1024},
+    {DynamicBandpassFilter::USB, "USB", 48000, 2048},
+    {DynamicBandpassFilter::LSB, "LSB", 48000, 2048},
+};
+
+static const size_t SAMPLES_PER_CASE = 1 << 22;
+static const double THROUGHPUT_TOLERANCE = 0.25;   // Fraction of the baseline a run may lose
+
+static double benchmarkThroughput(const BenchmarkCase& c, size_t total_samples) {
+    DynamicBandpassFilter filter;
+    if (!filter.initialize(c.sample_rate, c.fft_size)) return 0.0;
+    filter.setEnabled(true);
+    filter.setProtocol(c.protocol);
+
+    // Multi-tone plus noise: in-band, near-band and far out-of-band components
+    size_t block = static_cast<size_t>(c.fft_size) * 8;
+    std::vector<std::complex<float>> input(block);
+    const float tones[] = {0.02f, 0.11f, 0.37f};
+    uint32_t seed = 0x12345678u;
+    for (size_t i = 0; i < block; ++i) {
+        std::complex<float> sample(0.0f, 0.0f);
+        for (float tone : tones) {
+            sample += std::polar(0.2f, 2.0f * static_cast<float>(M_PI) * tone * static_cast<float>(i));
+        }
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.02f;
+        input[i] = sample + std::complex<float>(noise, -noise);
+    }
+
+    // One warm-up call designs the kernel before timing starts
+    filter.process(input);
+
+    size_t processed = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (processed < total_samples) {
+        filter.process(input);
+        processed += block;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? processed / seconds / 1e6 : 0.0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string baseline_path = "throughput_baseline.txt";
+    bool record = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0) {
+            record = true;
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    {
+        std::ifstream file(baseline_path);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name;
+            double msps = 0.0;
+            if (fields >> name >> msps) {
+                baseline[name] = msps;
+            }
+        }
+    }
+    record = record || baseline.empty();
+
+    bool passed = true;
+    std::ostringstream recorded;
+    recorded << "# protocol msps (written by filter_benchmark)\n";
+
+    for (const BenchmarkCase& c : CASES) {
+        double msps = benchmarkThroughput(c, SAMPLES_PER_CASE);
+        char line[64];
+        std::snprintf(line, sizeof(line), "%s %.3f\n", c.name, msps);
+        recorded << line;
+
+        auto base = baseline.find(c.name);
+        if (record || base == baseline.end()) {
+            std::printf("%-5s fft %5d  %8.2f MS/s\n", c.name, c.fft_size, msps);
+            continue;
+        }
+        double floor = base->second * (1.0 - THROUGHPUT_TOLERANCE);
+        bool ok = msps >= floor;
+        std::printf("%-5s fft %5d  %8.2f MS/s  baseline %8.2f  %s\n", c.name, c.fft_size, msps, base->second,
+                    ok ? "ok" : "REGRESSED");
+        passed &= ok;
+    }
+
+    if (record) {
+        std::ofstream file(baseline_path);
+        file << recorded.str();
+        if (!file) {
+            std::printf("FAIL could not write %s\n", baseline_path.c_str());
+            return 1;
+        }
+        std::printf("Baseline recorded to %s\n", baseline_path.c_str());
+    }
+
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+#include "FilterPipeline.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef FILTER_PIPELINE_AVAILABLE
+#error "filter_pipeline_test needs C++20 coroutines"
+#endif
+
+// Coroutine pipeline over capacity-1 channels: backpressure holds producers at the channel
+// bound, close() drains in order, a consumer that leaves stops the stages upstream, and a
+// stage that throws closes both channels instead of leaving its peers suspended.
+
+static const int SAMPLE_RATE = 48000;
+static const int FFT_SIZE = 1024;
+static const auto SETTLE_TIME = std::chrono::milliseconds(50);
+static const auto TASK_TIMEOUT = std::chrono::seconds(10);
+
+typedef BlockChannel<SampleBlock> Channel;
+
+static SampleBlock makeBlock(size_t length, size_t offset) {
+    SampleBlock block(length);
+    for (size_t i = 0; i < length; ++i) {
+        float phase = 0.05f * static_cast<float>(offset + i);
+        block[i] = std::complex<float>(std::cos(phase), std::sin(phase));
+    }
+    return block;
+}
+
+static std::vector<SampleBlock> makeBlocks(const std::vector<size_t>& lengths) {
+    std::vector<SampleBlock> blocks;
+    size_t offset = 0;
+    for (size_t length : lengths) {
+        blocks.push_back(makeBlock(length, offset));
+        offset += length;
+    }
+    return blocks;
+}
+
+static void initializeFilter(DynamicBandpassFilter& filter) {
+    filter.initialize(SAMPLE_RATE, FFT_SIZE);
+    filter.setEnabled(true);
+    filter.setProtocol(DynamicBandpassFilter::NBFM);
+}
+
+// Pushes every block, counting the ones accepted, then closes the channel
+static PipelineTask produce(Channel& output, std::vector<SampleBlock> blocks, std::atomic<int>& accepted) {
+    for (SampleBlock& block : blocks) {
+        if (!co_await output.push(std::move(block))) break;
+        accepted.fetch_add(1);
+    }
+    output.close();
+}
+
+// Pops until the channel is drained, or closes it after keep blocks
+static PipelineTask consume(Channel& input, std::vector<SampleBlock>& received, size_t keep) {
+    while (std::optional<SampleBlock> block = co_await input.pop()) {
+        received.push_back(std::move(*block));
+        if (received.size() == keep) {
+            input.close();
+            break;
+        }
+    }
+}
+
+// A hung pipeline cannot be torn down, so a timeout ends the test on the spot
+static void finish(PipelineTask& task, const char* what) {
+    auto deadline = std::chrono::steady_clock::now() + TASK_TIMEOUT;
+    while (!task.isDone()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::printf("FAIL %s did not finish\nFAIL\n", what);
+            std::exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static bool check(bool ok, const char* what) {
+    if (!ok) std::printf("FAIL %s\n", what);
+    return ok;
+}
+
+static bool testBackpressureAndDrain(PipelineExecutor& executor) {
+    const std::vector<size_t> lengths = {300, 1000, 77, 2048, 512, 948};
+    const std::vector<SampleBlock> blocks = makeBlocks(lengths);
+
+    DynamicBandpassFilter filter;
+    initializeFilter(filter);
+    Channel raw(executor, 1);
+    Channel filtered(executor, 1);
+    std::atomic<int> accepted(0);
+    std::vector<SampleBlock> received;
+
+    PipelineTask producer = produce(raw, blocks, accepted);
+    PipelineTask stage = filterStage(filter, raw, filtered);
+    producer.start(executor);
+    stage.start(executor);
+
+    // Nothing consumes yet: one block in each channel, one held by the stage's push and one
+    // by the producer's - and everyone suspended, not spinning
+    std::this_thread::sleep_for(SETTLE_TIME);
+    bool passed = true;
+    passed &= check(raw.size() == 1 && filtered.size() == 1, "channels exceeded capacity 1 under backpressure");
+    passed &= check(accepted.load() == 3, "producer was not held back by the full pipeline");
+    passed &= check(!producer.isDone() && !stage.isDone(), "stages finished without a consumer");
+
+    PipelineTask consumer = consume(filtered, received, 0);
+    consumer.start(executor);
+    finish(consumer, "backpressure consumer");
+    finish(stage, "backpressure filter stage");
+    finish(producer, "backpressure producer");
+    stage.wait();
+
+    // Everything comes through in order, exactly as one filter fed the same blocks directly
+    DynamicBandpassFilter reference;
+    initializeFilter(reference);
+    passed &= check(accepted.load() == static_cast<int>(blocks.size()) && received.size() == blocks.size(),
+                    "close() did not drain every block");
+    for (size_t i = 0; i < blocks.size() && i < received.size(); ++i) {
+        passed &= check(received[i] == reference.process(blocks[i]), "drained block differs from direct filtering");
+    }
+    passed &= check(raw.isClosed() && filtered.isClosed(), "channels left open after the drain");
+    return passed;
+}
+
+static bool testConsumerLeaves(PipelineExecutor& executor) {
+    DynamicBandpassFilter filter;
+    initializeFilter(filter);
+    Channel raw(executor, 1);
+    Channel filtered(executor, 1);
+    std::atomic<int> accepted(0);
+    std::vector<SampleBlock> received;
+
+    PipelineTask producer = produce(raw, makeBlocks(std::vector<size_t>(20, 512)), accepted);
+    PipelineTask stage = filterStage(filter, raw, filtered);
+    PipelineTask consumer = consume(filtered, received, 2);
+    producer.start(executor);
+    stage.start(executor);
+    consumer.start(executor);
+    finish(consumer, "early-exit consumer");
+    finish(stage, "filter stage after downstream close");
+    finish(producer, "producer after downstream close");
+    stage.wait();
+
+    bool passed = check(received.size() == 2, "consumer saw blocks after closing");
+    passed &= check(accepted.load() < 20, "producer kept pushing after downstream went away");
+    passed &= check(raw.isClosed(), "stage did not close its input when output closed");
+    return passed;
+}
+
+static bool testThrowingStage(PipelineExecutor& executor) {
+    Channel raw(executor, 1);
+    Channel transformed(executor, 1);
+    std::atomic<int> accepted(0);
+    std::vector<SampleBlock> received;
+
+    int calls = 0;
+    PipelineTask producer = produce(raw, makeBlocks(std::vector<size_t>(20, 256)), accepted);
+    PipelineTask stage = transformStage(raw, transformed, [&calls](SampleBlock block) {
+        if (++calls == 3) throw std::runtime_error("stage failure");
+        return block;
+    });
+    PipelineTask consumer = consume(transformed, received, 0);
+    producer.start(executor);
+    stage.start(executor);
+    consumer.start(executor);
+    finish(consumer, "consumer of a throwing stage");
+    finish(stage, "throwing stage");
+    finish(producer, "producer of a throwing stage");
+
+    bool rethrown = false;
+    try {
+        stage.wait();
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    bool passed = check(rethrown, "wait() did not rethrow the stage's exception");
+    passed &= check(received.size() == 2, "consumer did not get exactly the blocks before the throw");
+    passed &= check(accepted.load() < 20, "producer kept pushing into a failed stage");
+    passed &= check(raw.isClosed() && transformed.isClosed(), "throwing stage left a channel open");
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    {
+        PipelineExecutor executor(2);
+        passed &= testBackpressureAndDrain(executor);
+        passed &= testConsumerLeaves(executor);
+        passed &= testThrowingStage(executor);
+    }
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+#include "DynamicBandpassFilter.h"
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Kernel response regression test. For every Protocol the filter designs its kernel on a
+// multi-tone plus noise vector, then analyzeResponse() is checked against
+//   data/response_limits.txt    hard limits per protocol, with the rate and FFT size to test at
+//   data/response_baseline.txt  the last recorded measurement; drifting past the tolerances
+//                               below fails even inside the limits
+// After an intended change to the kernel design, re-record with --record.
+// The same ripple, stopband and edge limits then apply to tones streamed through process()
+// in calls of several sizes, which exercises the overlap history, short final frames and
+// continuity from one call to the next.
+
+static const char* PROTOCOL_NAMES[] = {"WFM", "NBFM", "AM", "USB", "LSB"};
+static const int PROTOCOL_COUNT = 5;
+
+// How far a measurement may move from the baseline in the bad direction
+static const float RIPPLE_TOLERANCE_DB = 0.05f;
+static const float ATTENUATION_TOLERANCE_DB = 1.0f;
+static const float EDGE_ERROR_TOLERANCE_DB = 3.0f;
+
+// Streaming: call sizes as multiples of the FFT size (one call per tone segment, several
+// frames per call) or fixed counts off the hop; each tone settles for an FFT frame first
+static const size_t STREAM_CALL_SIZES[] = {0, 1000, 333, 97};
+static const int STREAM_PASSBAND_TONES = 8;
+static const int STREAM_STOPBAND_TONES = 16;
+static const size_t STREAM_MEASURED_FFTS = 8;
+
+struct ResponseLimits {
+    int sample_rate;
+    int fft_size;
+    float max_ripple_db;
+    float min_stopband_db;
+    float min_sideband_db;      // 0 = not an SSB protocol
+    float max_edge_error_db;
+};
+
+typedef DynamicBandpassFilter::ResponseAnalysis ResponseAnalysis;
+
+// Whitespace-separated rows keyed by protocol name; '#' starts a comment line
+static std::map<std::string, std::vector<float>> readTable(const std::string& path, size_t columns) {
+    std::map<std::string, std::vector<float>> rows;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        std::vector<float> values(columns);
+        fields >> name;
+        for (float& value : values) {
+            fields >> value;
+        }
+        if (fields) {
+            rows[name] = values;
+        }
+    }
+    return rows;
+}
+
+static std::vector<std::complex<float>> makeTestVector(size_t length) {
+    // In-band, near-band and far out-of-band tones over low-level noise
+    const float tones[] = {0.004f, 0.03f, 0.21f, -0.33f};
+    std::vector<std::complex<float>> samples(length);
+    uint32_t seed = 0x2545f491u;
+    for (size_t i = 0; i < length; ++i) {
+        std::complex<float> sample(0.0f, 0.0f);
+        for (float tone : tones) {
+            sample += std::polar(0.2f, 2.0f * static_cast<float>(M_PI) * tone * static_cast<float>(i));
+        }
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.01f;
+        samples[i] = sample + std::complex<float>(noise, -noise);
+    }
+    return samples;
+}
+
+static bool measure(int protocol, const ResponseLimits& limits, ResponseAnalysis& analysis) {
+    DynamicBandpassFilter filter;
+    if (!filter.initialize(limits.sample_rate, limits.fft_size)) return false;
+    filter.setEnabled(true);
+    filter.setProtocol(static_cast<DynamicBandpassFilter::Protocol>(protocol));
+
+    // The kernel is designed on the first process() call
+    filter.process(makeTestVector(static_cast<size_t>(limits.fft_size) * 4));
+    analysis = filter.analyzeResponse();
+    return analysis.tones_measured > 0;
+}
+
+struct StreamMeasurement {
+    float ripple_db;
+    float stopband_db;
+    float error_db;             // Output against the ideal scaled tone, across every call join
+};
+
+// Streams one tone through process() in calls of call_size samples. Returns the complex gain
+// from the projection onto the tone, and the residual against gain * tone relative to it.
+static std::complex<double> streamTone(DynamicBandpassFilter& filter, double sample_rate, size_t settle,
+                                       size_t measured, size_t call_size, float freq, double* error_db) {
+    const double step = 2.0 * M_PI * freq / sample_rate;
+    std::vector<std::complex<float>> input;
+    std::vector<std::complex<float>> output;
+    output.reserve(settle + measured);
+    for (size_t pos = 0; pos < settle + measured; pos += call_size) {
+        size_t count = std::min(call_size, settle + measured - pos);
+        input.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            input[i] = std::complex<float>(std::polar(1.0, step * static_cast<double>(pos + i)));
+        }
+        std::vector<std::complex<float>> filtered = filter.process(input);
+        output.insert(output.end(), filtered.begin(), filtered.end());
+    }
+    if (output.size() != settle + measured) return 0.0;
+
+    std::complex<double> gain(0.0, 0.0);
+    for (size_t n = settle; n < output.size(); ++n) {
+        gain += std::complex<double>(output[n]) * std::polar(1.0, -step * static_cast<double>(n));
+    }
+    gain /= static_cast<double>(measured);
+
+    if (error_db) {
+        double error = 0.0;
+        for (size_t n = settle; n < output.size(); ++n) {
+            error += std::norm(std::complex<double>(output[n]) - gain * std::polar(1.0, step * static_cast<double>(n)));
+        }
+        *error_db = 10.0 * std::log10(error / (std::norm(gain) * measured) + 1e-20);
+    }
+    return gain;
+}
+
+static bool measureStreaming(int protocol, const ResponseLimits& limits, const ResponseAnalysis& analysis,
+                             size_t call_size, StreamMeasurement& m) {
+    DynamicBandpassFilter filter;
+    if (!filter.initialize(limits.sample_rate, limits.fft_size)) return false;
+    filter.setEnabled(true);
+    filter.setProtocol(static_cast<DynamicBandpassFilter::Protocol>(protocol));
+    filter.process(makeTestVector(static_cast<size_t>(limits.fft_size)));
+
+    const double rate = limits.sample_rate;
+    const size_t settle = static_cast<size_t>(limits.fft_size);
+    const size_t measured = static_cast<size_t>(limits.fft_size) * STREAM_MEASURED_FFTS;
+    if (call_size == 0) call_size = settle + measured;
+
+    // Passband: ripple over the analyzed flat region, plus the error of an off-bin tone
+    float max_gain = -200.0f;
+    float min_gain = 200.0f;
+    m.error_db = -200.0f;
+    for (int t = 0; t < STREAM_PASSBAND_TONES; ++t) {
+        float freq = analysis.flat_low_hz +
+                     (analysis.flat_high_hz - analysis.flat_low_hz) * (t + 0.37f) / STREAM_PASSBAND_TONES;
+        double error_db = 0.0;
+        float gain = 20.0f * std::log10(static_cast<float>(std::abs(
+            streamTone(filter, rate, settle, measured, call_size, freq, &error_db))) + 1e-10f);
+        max_gain = std::max(max_gain, gain);
+        min_gain = std::min(min_gain, gain);
+        m.error_db = std::max(m.error_db, static_cast<float>(error_db));
+    }
+    m.ripple_db = max_gain - min_gain;
+
+    // Stopband: evenly spread tones outside the analyzed transition bands
+    float worst = -200.0f;
+    const float nyquist = static_cast<float>(rate / 2.0);
+    for (int t = 0; t < STREAM_STOPBAND_TONES; ++t) {
+        float freq = -nyquist + 2.0f * nyquist * (t + 0.5f) / STREAM_STOPBAND_TONES;
+        if (freq > analysis.stopband_low_hz && freq < analysis.stopband_high_hz) continue;
+        float gain = 20.0f * std::log10(static_cast<float>(std::abs(
+            streamTone(filter, rate, settle, measured, call_size, freq, nullptr))) + 1e-10f);
+        worst = std::max(worst, gain);
+    }
+    m.stopband_db = -worst;
+    return true;
+}
+
+static bool check(bool ok, const char* protocol, const char* what, float value, const char* relation, float bound) {
+    if (!ok) {
+        std::printf("FAIL %-5s %s %.3f dB, expected %s %.3f dB\n", protocol, what, value, relation, bound);
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    bool record = argc > 1 && std::strcmp(argv[1], "--record") == 0;
+    const std::string limits_path = std::string(TEST_DATA_DIR) + "/response_limits.txt";
+    const std::string baseline_path = std::string(TEST_DATA_DIR) + "/response_baseline.txt";
+
+    std::map<std::string, std::vector<float>> limit_rows = readTable(limits_path, 6);
+    std::map<std::string, std::vector<float>> baseline_rows = readTable(baseline_path, 4);
+
+    bool passed = true;
+    std::ostringstream recorded;
+    recorded << "# protocol ripple_db stopband_db sideband_db edge_error_db (written by --record)\n";
+
+    for (int p = 0; p < PROTOCOL_COUNT; ++p) {
+        const char* name = PROTOCOL_NAMES[p];
+        auto row = limit_rows.find(name);
+        if (row == limit_rows.end()) {
+            std::printf("FAIL %-5s no limits in %s\n", name, limits_path.c_str());
+            passed = false;
+            continue;
+        }
+        const std::vector<float>& v = row->second;
+        ResponseLimits limits = {static_cast<int>(v[0]), static_cast<int>(v[1]), v[2], v[3], v[4], v[5]};
+
+        ResponseAnalysis a;
+        if (!measure(p, limits, a)) {
+            std::printf("FAIL %-5s no kernel to analyze\n", name);
+            passed = false;
+            continue;
+        }
+        std::printf("%-5s ripple %.3f dB, stopband %.2f dB, sideband %.2f dB, edge error %.1f dB\n", name,
+                    a.passband_ripple_db, a.stopband_attenuation_db, a.sideband_rejection_db, a.block_edge_error_db);
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "%s %.3f %.3f %.3f %.3f\n", name, a.passband_ripple_db,
+                      a.stopband_attenuation_db, a.sideband_rejection_db, a.block_edge_error_db);
+        recorded << line;
+
+        passed &= check(a.passband_ripple_db <= limits.max_ripple_db, name, "ripple", a.passband_ripple_db,
+                        "<=", limits.max_ripple_db);
+        passed &= check(a.stopband_attenuation_db >= limits.min_stopband_db, name, "stopband",
+                        a.stopband_attenuation_db, ">=", limits.min_stopband_db);
+        if (limits.min_sideband_db > 0.0f) {
+            passed &= check(a.sideband_rejection_db >= limits.min_sideband_db, name, "sideband rejection",
+                            a.sideband_rejection_db, ">=", limits.min_sideband_db);
+        }
+        passed &= check(a.block_edge_error_db <= limits.max_edge_error_db, name, "edge error",
+                        a.block_edge_error_db, "<=", limits.max_edge_error_db);
+
+        for (size_t call_size : STREAM_CALL_SIZES) {
+            StreamMeasurement m;
+            if (!measureStreaming(p, limits, a, call_size, m)) {
+                std::printf("FAIL %-5s streaming in calls of %zu produced no output\n", name, call_size);
+                passed = false;
+                continue;
+            }
+            char what[64];
+            if (call_size == 0) {
+                std::snprintf(what, sizeof(what), "streamed in single calls");
+            } else {
+                std::snprintf(what, sizeof(what), "streamed in calls of %zu", call_size);
+            }
+            std::printf("%-5s %-26s ripple %.3f dB, stopband %.2f dB, stream error %.1f dB\n", name, what,
+                        m.ripple_db, m.stopband_db, m.error_db);
+            std::string label = std::string(what) + ": ";
+            passed &= check(m.ripple_db <= limits.max_ripple_db, name, (label + "ripple").c_str(), m.ripple_db,
+                            "<=", limits.max_ripple_db);
+            passed &= check(m.stopband_db >= limits.min_stopband_db, name, (label + "stopband").c_str(),
+                            m.stopband_db, ">=", limits.min_stopband_db);
+            passed &= check(m.error_db <= limits.max_edge_error_db, name, (label + "stream error").c_str(),
+                            m.error_db, "<=", limits.max_edge_error_db);
+        }
+
+        if (record) continue;
+        auto base = baseline_rows.find(name);
+        if (base == baseline_rows.end()) {
+            std::printf("FAIL %-5s no baseline in %s - run with --record\n", name, baseline_path.c_str());
+            passed = false;
+            continue;
+        }
+        const std::vector<float>& b = base->second;
+        passed &= check(a.passband_ripple_db <= b[0] + RIPPLE_TOLERANCE_DB, name, "ripple vs baseline",
+                        a.passband_ripple_db, "<=", b[0] + RIPPLE_TOLERANCE_DB);
+        passed &= check(a.stopband_attenuation_db >= b[1] - ATTENUATION_TOLERANCE_DB, name, "stopband vs baseline",
+                        a.stopband_attenuation_db, ">=", b[1] - ATTENUATION_TOLERANCE_DB);
+        passed &= check(a.sideband_rejection_db >= b[2] - ATTENUATION_TOLERANCE_DB, name, "sideband vs baseline",
+                        a.sideband_rejection_db, ">=", b[2] - ATTENUATION_TOLERANCE_DB);
+        passed &= check(a.block_edge_error_db <= b[3] + EDGE_ERROR_TOLERANCE_DB, name, "edge error vs baseline",
+                        a.block_edge_error_db, "<=", b[3] + EDGE_ERROR_TOLERANCE_DB);
+    }
+
+    if (record) {
+        std::ofstream file(baseline_path);
+        file << recorded.str();
+        if (!file) {
+            std::printf("FAIL could not write %s\n", baseline_path.c_str());
+            return 1;
+        }
+        std::printf("Baseline recorded to %s\n", baseline_path.c_str());
+    }
+
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include "DynamicBandpassFilter.h"
+#include "SpectralNoiseReducer.h"
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Noise reduction through the bandpass filter's shared FFT pair. Checks that every Method
+// raises the SNR of a tone in noise, and that the suppression does not depend on how the
+// caller chunks the stream.
+
+static const int SAMPLE_RATE = 48000;
+static const int FFT_SIZE = 1024;
+static const size_t STREAM_SAMPLES = 48000 * 4;
+static const float CHUNK_TOLERANCE_DB = 0.5f;
+static const float TONE_HZ = 1000.0f;
+static const size_t TONE_CHUNK = 1000;             // Not a multiple of the hop
+static const size_t TONE_START = 48000;            // Noise-only lead-in: a tone present during
+                                                   // training would be learned as noise
+static const float MIN_SNR_GAIN_DB = 3.0f;         // Over the bandpass filter alone
+
+// Complex Gaussian noise (Box-Muller on a fixed LCG) plus an optional tone from tone_start on
+static std::vector<std::complex<float>> makeSignal(size_t length, float tone_hz, float tone_amplitude,
+                                                   float noise_rms, size_t tone_start = 0) {
+    std::vector<std::complex<float>> samples(length);
+    uint32_t seed = 0x9e3779b9u;
+    auto uniform = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (static_cast<float>(seed >> 8) + 0.5f) / 16777216.0f;
+    };
+    for (size_t i = 0; i < length; ++i) {
+        float radius = noise_rms * std::sqrt(-std::log(uniform()));
+        float angle = 2.0f * static_cast<float>(M_PI) * uniform();
+        float phase = 2.0f * static_cast<float>(M_PI) * tone_hz * static_cast<float>(i) / SAMPLE_RATE;
+        samples[i] = std::polar(radius, angle) + std::polar(i >= tone_start ? tone_amplitude : 0.0f, phase);
+    }
+    return samples;
+}
+
+static std::shared_ptr<DynamicBandpassFilter> makeFilter(std::shared_ptr<SpectralNoiseReducer> reducer) {
+    auto filter = std::make_shared<DynamicBandpassFilter>();
+    filter->initialize(SAMPLE_RATE, FFT_SIZE);
+    filter->setEnabled(true);
+    filter->setProtocol(DynamicBandpassFilter::NBFM);
+    if (reducer) {
+        filter->setNoiseReducer(reducer);
+    }
+    return filter;
+}
+
+// Streams the input in fixed-size calls and returns the concatenated output
+static std::vector<std::complex<float>> runChunked(DynamicBandpassFilter& filter,
+                                                   const std::vector<std::complex<float>>& input, size_t chunk) {
+    std::vector<std::complex<float>> output;
+    output.reserve(input.size());
+    for (size_t pos = 0; pos < input.size(); pos += chunk) {
+        size_t count = std::min(chunk, input.size() - pos);
+        std::vector<std::complex<float>> block(input.begin() + pos, input.begin() + pos + count);
+        std::vector<std::complex<float>> filtered = filter.process(block);
+        output.insert(output.end(), filtered.begin(), filtered.end());
+    }
+    return output;
+}
+
+// Mean power over the second half, once the noise estimate has settled
+static double tailPowerDb(const std::vector<std::complex<float>>& samples) {
+    double power = 0.0;
+    size_t start = samples.size() / 2;
+    for (size_t i = start; i < samples.size(); ++i) {
+        power += std::norm(samples[i]);
+    }
+    return 10.0 * std::log10(power / (samples.size() - start) + 1e-30);
+}
+
+// Tone-to-residual power ratio over the second half. The tone's share is its projection
+// onto the known frequency, which the filter's delay only rotates.
+static double toneSnrDb(const std::vector<std::complex<float>>& samples) {
+    size_t start = samples.size() / 2;
+    std::complex<double> projection(0.0, 0.0);
+    double total = 0.0;
+    for (size_t i = start; i < samples.size(); ++i) {
+        double phase = 2.0 * M_PI * TONE_HZ * static_cast<double>(i) / SAMPLE_RATE;
+        projection += std::complex<double>(samples[i]) * std::polar(1.0, -phase);
+        total += std::norm(samples[i]);
+    }
+    size_t length = samples.size() - start;
+    double tone = std::norm(projection / static_cast<double>(length));
+    double residual = std::max(total / length - tone, 1e-30);
+    return 10.0 * std::log10(tone / residual);
+}
+
+static bool testSnrGainPerMethod() {
+    const std::vector<std::complex<float>> input = makeSignal(STREAM_SAMPLES, TONE_HZ, 0.1f, 0.1f, TONE_START);
+    auto reference = makeFilter(nullptr);
+    double filtered_snr = toneSnrDb(runChunked(*reference, input, TONE_CHUNK));
+    std::printf("bandpass only: tone SNR %.2f dB\n", filtered_snr);
+
+    const SpectralNoiseReducer::Method methods[] = {SpectralNoiseReducer::SPECTRAL_SUBTRACTION,
+                                                    SpectralNoiseReducer::NOISE_GATE, SpectralNoiseReducer::WIENER};
+    const char* names[] = {"spectral subtraction", "noise gate", "wiener"};
+    bool passed = true;
+    for (int m = 0; m < 3; ++m) {
+        auto filter = makeFilter(std::make_shared<SpectralNoiseReducer>(methods[m]));
+        double gain = toneSnrDb(runChunked(*filter, input, TONE_CHUNK)) - filtered_snr;
+        std::printf("%-20s: SNR gain %.2f dB\n", names[m], gain);
+        if (gain < MIN_SNR_GAIN_DB) {
+            std::printf("FAIL %s gains %.2f dB, expected >= %.2f dB\n", names[m], gain, MIN_SNR_GAIN_DB);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+static bool testChunkSizeIndependence() {
+    // The overlap-save hop of the designed kernel; a probe filter designs it without
+    // touching the instances under test
+    size_t hop;
+    {
+        auto probe = makeFilter(nullptr);
+        probe->process(std::vector<std::complex<float>>(FFT_SIZE));
+        DynamicBandpassFilter::FilterStats stats = probe->getStats();
+        hop = static_cast<size_t>(stats.fft_size - (stats.kernel_length - 1));
+    }
+
+    const std::vector<std::complex<float>> noise = makeSignal(STREAM_SAMPLES, 0.0f, 0.0f, 0.1f);
+    auto reference = makeFilter(nullptr);
+    double unreduced_db = tailPowerDb(runChunked(*reference, noise, hop));
+
+    const size_t chunks[] = {hop, hop * 3, 1000, 333};
+    double suppression[4];
+    bool passed = true;
+    for (int c = 0; c < 4; ++c) {
+        auto filter = makeFilter(std::make_shared<SpectralNoiseReducer>(SpectralNoiseReducer::WIENER));
+        suppression[c] = unreduced_db - tailPowerDb(runChunked(*filter, noise, chunks[c]));
+        std::printf("chunk %5zu%s: noise suppressed by %.2f dB\n", chunks[c],
+                    chunks[c] % hop == 0 ? " (hop-aligned)" : "", suppression[c]);
+        if (std::abs(suppression[c] - suppression[0]) > CHUNK_TOLERANCE_DB) {
+            std::printf("FAIL chunk %zu differs from the hop-aligned run by %.2f dB (tolerance %.2f dB)\n",
+                        chunks[c], suppression[c] - suppression[0], CHUNK_TOLERANCE_DB);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+int main() {
+    bool passed = testSnrGainPerMethod();
+    passed &= testChunkSizeIndependence();
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
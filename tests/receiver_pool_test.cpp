@@ -0,0 +1,218 @@
+#include "DynamicBandpassFilter.h"
+#include "ReceiverPool.h"
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ReceiverPool with 2 workers and 3 streams: per-stream processed, bypassed and overrun
+// counts from getStats() must match what the test submitted and what the callbacks saw.
+// Stream 1's callback holds its worker on a latch, so its overruns are exact; streams 0 and
+// 2 share the other worker, and stream 2's filter is disabled so its blocks are bypassed.
+// The filter's own pool overload counts the blocks it cannot deliver in FilterStats.
+
+static const int SAMPLE_RATE = 48000;
+static const int FFT_SIZE = 1024;
+static const size_t QUEUE_DEPTH = 4;
+static const size_t BLOCK_SAMPLES = 1024;
+static const int BLOCKS_PER_STREAM = 40;
+static const int STALLED_EXTRA_SUBMITS = 3;
+static const auto DRAIN_TIMEOUT = std::chrono::seconds(10);
+
+struct SubmitTally {
+    uint64_t attempts = 0;
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+};
+
+// Holds stream 1's worker inside the output callback until opened
+class Latch {
+public:
+    void waitOpen() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        entered_ = true;
+        changed_.notify_all();
+        changed_.wait(lock, [this]() { return open_; });
+    }
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return entered_; });
+    }
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        changed_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool entered_ = false;
+    bool open_ = false;
+};
+
+static std::shared_ptr<DynamicBandpassFilter> makeFilter(bool enabled) {
+    auto filter = std::make_shared<DynamicBandpassFilter>();
+    filter->initialize(SAMPLE_RATE, FFT_SIZE);
+    filter->setProtocol(DynamicBandpassFilter::NBFM);
+    filter->setEnabled(enabled);
+    return filter;
+}
+
+static bool submitCounted(ReceiverPool& pool, int stream, const std::vector<std::complex<float>>& block,
+                          SubmitTally& tally) {
+    ++tally.attempts;
+    bool accepted = pool.submit(stream, block.data(), block.size());
+    ++(accepted ? tally.accepted : tally.rejected);
+    return accepted;
+}
+
+static bool check(bool ok, int stream, const char* what, unsigned long long value, unsigned long long expected) {
+    if (!ok) std::printf("FAIL stream %d %s %llu, expected %llu\n", stream, what, value, expected);
+    return ok;
+}
+
+// An exhausted pool and an input larger than a block each return an empty handle and are
+// counted once, in the matching FilterStats field
+static bool testFilterPoolDrops() {
+    std::shared_ptr<DynamicBandpassFilter> filter = makeFilter(true);
+    SampleBlockPool pool(BLOCK_SAMPLES, 1);
+    std::vector<std::complex<float>> block(BLOCK_SAMPLES, std::complex<float>(0.25f, -0.25f));
+    std::vector<uint8_t> cu8(2 * BLOCK_SAMPLES + 2, 128);
+
+    bool passed = check(!filter->process(block.data(), block.size() + 1, pool), -1, "oversized block returned",
+                        1, 0);
+    passed &= check(!filter->processCU8(cu8.data(), cu8.size(), pool), -1, "oversized cu8 block returned", 1, 0);
+    SampleBlockPool::Block held = filter->process(block.data(), block.size(), pool);
+    passed &= check(static_cast<bool>(held), -1, "block filtered from a free pool", 0, 1);
+    passed &= check(!filter->process(block.data(), block.size(), pool), -1, "block returned from an empty pool",
+                    1, 0);
+    passed &= check(!filter->processCU8(cu8.data(), 2 * BLOCK_SAMPLES, pool), -1,
+                    "cu8 block returned from an empty pool", 1, 0);
+
+    DynamicBandpassFilter::FilterStats stats = filter->getStats();
+    passed &= check(stats.pool_exhausted_drops == 2, -1, "pool exhausted drops", stats.pool_exhausted_drops, 2);
+    passed &= check(stats.oversized_input_drops == 2, -1, "oversized input drops", stats.oversized_input_drops, 2);
+    return passed;
+}
+
+int main() {
+    bool passed = testFilterPoolDrops();
+
+    ReceiverPool::PoolConfig config;
+    config.worker_count = 2;
+    config.queue_depth = QUEUE_DEPTH;
+    config.max_block_samples = BLOCK_SAMPLES * 2;
+    ReceiverPool pool(config);
+
+    const int STREAMS = 3;
+    std::atomic<uint64_t> delivered[STREAMS] = {};
+    Latch latch;
+    auto callback = [&](int stream_id, SampleBlockPool::Block&& output) {
+        delivered[stream_id].fetch_add(output.size());
+        if (stream_id == 1) latch.waitOpen();
+    };
+    int ids[STREAMS] = {pool.addStream(makeFilter(true), callback), pool.addStream(makeFilter(true), callback),
+                        pool.addStream(makeFilter(false), callback)};
+    pool.start();
+
+    std::vector<std::complex<float>> block(BLOCK_SAMPLES, std::complex<float>(0.25f, -0.25f));
+    SubmitTally tally[STREAMS];
+
+    // Stream 1: the first block parks the worker in the callback; the pool then holds exactly
+    // QUEUE_DEPTH more, and every submit past that is an input overrun
+    submitCounted(pool, ids[1], block, tally[1]);
+    latch.waitEntered();
+    for (size_t i = 0; i < QUEUE_DEPTH + STALLED_EXTRA_SUBMITS; ++i) {
+        submitCounted(pool, ids[1], block, tally[1]);
+    }
+
+    // Streams 0 and 2 share the other worker; a full queue is retried, each refusal counted
+    std::vector<std::complex<float>> oversized(config.max_block_samples + 1);
+    passed &= !pool.submit(ids[2], oversized.data(), oversized.size());
+    for (int b = 0; b < BLOCKS_PER_STREAM; ++b) {
+        for (int s : {0, 2}) {
+            while (!submitCounted(pool, ids[s], block, tally[s])) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+    latch.open();
+
+    // Wait for every accepted block to come out of its filter
+    auto deadline = std::chrono::steady_clock::now() + DRAIN_TIMEOUT;
+    ReceiverPool::PoolStats stats;
+    while (true) {
+        stats = pool.getStats();
+        bool drained = true;
+        for (int s = 0; s < STREAMS; ++s) {
+            drained &= stats.streams[s].blocks_processed == tally[s].accepted;
+        }
+        if (drained) break;
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::printf("FAIL pool did not drain the accepted blocks\n");
+            passed = false;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.stop();
+    stats = pool.getStats();
+
+    passed &= check(stats.worker_utilization.size() == 2, -1, "workers", stats.worker_utilization.size(), 2);
+    uint64_t total_processed = 0;
+    uint64_t total_overruns = 0;
+    for (int s = 0; s < STREAMS; ++s) {
+        const ReceiverPool::StreamStats& st = stats.streams[s];
+        std::printf("stream %d worker %d: submitted %llu processed %llu bypassed %llu blocks %llu overruns %llu "
+                    "oversized %llu high water %zu\n", s, st.worker,
+                    static_cast<unsigned long long>(st.samples_submitted),
+                    static_cast<unsigned long long>(st.samples_processed),
+                    static_cast<unsigned long long>(st.samples_bypassed),
+                    static_cast<unsigned long long>(st.blocks_processed),
+                    static_cast<unsigned long long>(st.input_overruns),
+                    static_cast<unsigned long long>(st.oversized_submits), st.queue_high_water);
+
+        uint64_t accepted_samples = tally[s].accepted * BLOCK_SAMPLES;
+        uint64_t submitted_samples = tally[s].attempts * BLOCK_SAMPLES + (s == 2 ? oversized.size() : 0);
+        passed &= check(st.worker == (s == 1 ? 1 : 0), s, "worker", st.worker, s == 1 ? 1 : 0);
+        passed &= check(st.samples_submitted == submitted_samples, s, "samples submitted", st.samples_submitted,
+                        submitted_samples);
+        passed &= check(st.input_overruns == tally[s].rejected, s, "input overruns", st.input_overruns,
+                        tally[s].rejected);
+        passed &= check(st.output_overruns == 0, s, "output overruns", st.output_overruns, 0);
+        passed &= check(st.oversized_submits == (s == 2 ? 1u : 0u), s, "oversized submits", st.oversized_submits,
+                        s == 2 ? 1 : 0);
+        passed &= check(delivered[s].load() == accepted_samples, s, "samples delivered", delivered[s].load(),
+                        accepted_samples);
+        // Stream 2's filter is disabled: everything it returns is a bypass, not a filter pass
+        uint64_t expected_processed = (s == 2) ? 0 : accepted_samples;
+        uint64_t expected_bypassed = (s == 2) ? accepted_samples : 0;
+        passed &= check(st.samples_processed == expected_processed, s, "samples processed", st.samples_processed,
+                        expected_processed);
+        passed &= check(st.samples_bypassed == expected_bypassed, s, "samples bypassed", st.samples_bypassed,
+                        expected_bypassed);
+        passed &= check(st.queue_high_water <= QUEUE_DEPTH, s, "queue high water", st.queue_high_water, QUEUE_DEPTH);
+        total_processed += st.samples_processed;
+        total_overruns += st.input_overruns + st.output_overruns;
+    }
+
+    // The stalled stream: one block in the callback, QUEUE_DEPTH queued, the rest refused
+    passed &= check(tally[1].accepted == 1 + QUEUE_DEPTH, 1, "accepted while stalled", tally[1].accepted,
+                    1 + QUEUE_DEPTH);
+    passed &= check(tally[1].rejected == STALLED_EXTRA_SUBMITS, 1, "refused while stalled", tally[1].rejected,
+                    STALLED_EXTRA_SUBMITS);
+    passed &= check(stats.total_samples_processed == total_processed, -1, "total processed",
+                    stats.total_samples_processed, total_processed);
+    passed &= check(stats.total_overruns == total_overruns, -1, "total overruns", stats.total_overruns,
+                    total_overruns);
+
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
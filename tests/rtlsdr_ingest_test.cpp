@@ -0,0 +1,116 @@
+#include "DynamicBandpassFilter.h"
+#include "RtlSdrIngest.h"
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// cu8 ingest through FakeRtlSdrDriver, unpaced: every sample the driver hands over comes
+// back out of the filter with nothing dropped, an in-band tone passes and one far outside
+// the NBFM channel is rejected.
+
+static const uint32_t SAMPLE_RATE = 240000;
+static const int FFT_SIZE = 4096;
+static const uint32_t BUFFER_LENGTH = 16384;           // Bytes, 2 per sample
+static const uint64_t BUFFERS_PER_RUN = 64;
+static const uint64_t SETTLE_SAMPLES = SAMPLE_RATE / 10;
+static const float IN_BAND_HZ = 2000.0f;
+static const float OUT_OF_BAND_HZ = 40000.0f;
+static const float TONE_AMPLITUDE = 0.5f;
+static const double MAX_PASSBAND_LOSS_DB = 1.0;
+static const double MIN_REJECTION_DB = 46.0;
+
+struct IngestRun {
+    RtlSdrIngest::IngestStats stats;
+    uint64_t delivered;
+    double tone_db;         // Output power at the tone frequency
+};
+
+static IngestRun runIngest(float tone_hz) {
+    auto filter = std::make_shared<DynamicBandpassFilter>();
+    filter->initialize(SAMPLE_RATE, FFT_SIZE);
+    filter->setEnabled(true);
+    filter->setProtocol(DynamicBandpassFilter::NBFM);
+
+    auto driver = std::make_shared<FakeRtlSdrDriver>(SAMPLE_RATE, tone_hz, TONE_AMPLITUDE);
+    driver->setRealTimePacing(false);
+
+    // The sink runs on the driver thread. Projecting onto the tone keeps the driver's noise
+    // out of the figure; the filter's delay only rotates the result.
+    uint64_t position = 0;
+    std::complex<double> projection(0.0, 0.0);
+    uint64_t projected = 0;
+    const double step = 2.0 * M_PI * tone_hz / SAMPLE_RATE;
+    auto sink = [&](SampleBlockPool::Block&& block) {
+        for (size_t i = 0; i < block.size(); ++i, ++position) {
+            if (position < SETTLE_SAMPLES) continue;
+            projection += std::complex<double>(block.data()[i]) * std::polar(1.0, -step * static_cast<double>(position));
+            ++projected;
+        }
+    };
+
+    IngestRun run;
+    {
+        RtlSdrIngest ingest(driver, filter, sink, 15, BUFFER_LENGTH);
+        ingest.start();
+        while (ingest.getStats().buffers < BUFFERS_PER_RUN) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ingest.stop();
+        run.stats = ingest.getStats();
+    }
+    run.delivered = driver->getBuffersDelivered();
+    double amplitude = projected ? std::abs(projection) / static_cast<double>(projected) : 0.0;
+    run.tone_db = 20.0 * std::log10(amplitude + 1e-30);
+    return run;
+}
+
+static bool checkAccounting(const char* name, const IngestRun& run) {
+    const RtlSdrIngest::IngestStats& s = run.stats;
+    std::printf("%-12s buffers %llu (driver %llu), samples in %llu out %llu, dropped %llu, worst callback %.2f ms\n",
+                name, static_cast<unsigned long long>(s.buffers), static_cast<unsigned long long>(run.delivered),
+                static_cast<unsigned long long>(s.samples_in), static_cast<unsigned long long>(s.samples_out),
+                static_cast<unsigned long long>(s.dropped_buffers), s.max_callback_ms);
+    bool passed = true;
+    if (s.samples_out != s.samples_in || s.samples_in != s.buffers * (BUFFER_LENGTH / 2)) {
+        std::printf("FAIL %s lost samples between driver and sink\n", name);
+        passed = false;
+    }
+    if (s.dropped_buffers != 0) {
+        std::printf("FAIL %s dropped %llu buffers\n", name, static_cast<unsigned long long>(s.dropped_buffers));
+        passed = false;
+    }
+    return passed;
+}
+
+int main() {
+    IngestRun in_band = runIngest(IN_BAND_HZ);
+    IngestRun out_of_band = runIngest(OUT_OF_BAND_HZ);
+
+    bool passed = checkAccounting("in-band", in_band);
+    passed &= checkAccounting("out-of-band", out_of_band);
+
+    double input_db = 20.0 * std::log10(TONE_AMPLITUDE);
+    double loss = input_db - in_band.tone_db;
+    double rejection = in_band.tone_db - out_of_band.tone_db;
+    std::printf("%.0f Hz tone: %.2f dB through the filter; %.0f Hz tone rejected by %.2f dB\n", IN_BAND_HZ, -loss,
+                OUT_OF_BAND_HZ, rejection);
+    if (std::abs(loss) > MAX_PASSBAND_LOSS_DB) {
+        std::printf("FAIL in-band tone changed by %.2f dB, expected within %.2f dB\n", -loss, MAX_PASSBAND_LOSS_DB);
+        passed = false;
+    }
+    if (rejection < MIN_REJECTION_DB) {
+        std::printf("FAIL out-of-band tone rejected by %.2f dB, expected >= %.2f dB\n", rejection, MIN_REJECTION_DB);
+        passed = false;
+    }
+
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "StereoMPXDemux.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// WFM-MPX split of a synthetic stereo multiplex: L and R tones matrixed into L+R, the
+// 19 kHz pilot and L-R on the suppressed 38 kHz carrier. Each output, fed in uneven
+// call sizes, must match its ideal component delayed by the shared group delay.
+
+static const double SAMPLE_RATE = 250000.0;
+static const double PILOT_HZ = 19000.0;
+static const double LEFT_HZ = 1000.0;
+static const double RIGHT_HZ = 3300.0;
+static const double LEFT_AMPLITUDE = 0.4;
+static const double RIGHT_AMPLITUDE = 0.3;
+static const double PILOT_AMPLITUDE = 0.1;
+static const size_t TOTAL_SAMPLES = 250000;
+static const double MAX_ERROR_DB = -55.0;
+
+struct MPXComponents {
+    double mono;
+    double pilot;
+    double difference;
+};
+
+static MPXComponents components(double n) {
+    double t = n / SAMPLE_RATE;
+    double left = LEFT_AMPLITUDE * std::sin(2.0 * M_PI * LEFT_HZ * t);
+    double right = RIGHT_AMPLITUDE * std::sin(2.0 * M_PI * RIGHT_HZ * t);
+    MPXComponents c;
+    c.mono = 0.5 * (left + right);
+    c.pilot = PILOT_AMPLITUDE * std::sin(2.0 * M_PI * PILOT_HZ * t);
+    c.difference = 0.5 * (left - right) * std::sin(2.0 * M_PI * 2.0 * PILOT_HZ * t);
+    return c;
+}
+
+// Error power relative to the reference, in dB, past the kernel's start-up
+static double errorDb(const std::vector<float>& output, double MPXComponents::*member, int delay) {
+    double error = 0.0;
+    double reference = 0.0;
+    for (size_t n = 2 * static_cast<size_t>(delay); n < output.size(); ++n) {
+        double expected = components(static_cast<double>(n) - delay).*member;
+        double diff = output[n] - expected;
+        error += diff * diff;
+        reference += expected * expected;
+    }
+    return 10.0 * std::log10((error + 1e-30) / (reference + 1e-30));
+}
+
+int main() {
+    StereoMPXDemux demux;
+    if (!demux.isValid()) {
+        std::printf("FAIL demux rejected the default configuration\nFAIL\n");
+        return 1;
+    }
+
+    std::vector<float> mpx(TOTAL_SAMPLES);
+    for (size_t n = 0; n < TOTAL_SAMPLES; ++n) {
+        MPXComponents c = components(static_cast<double>(n));
+        mpx[n] = static_cast<float>(c.mono + c.pilot + c.difference);
+    }
+
+    // Uneven call sizes, so blocks straddle calls and the held input is exercised
+    const size_t call_sizes[] = {1000, 333, 4097, 97};
+    StereoMPXDemux::MPXChannels output;
+    size_t produced = 0;
+    size_t offset = 0;
+    for (size_t call = 0; offset < TOTAL_SAMPLES; ++call) {
+        size_t count = std::min(call_sizes[call % 4], TOTAL_SAMPLES - offset);
+        produced += demux.process(mpx.data() + offset, count, output);
+        offset += count;
+    }
+
+    bool passed = true;
+    if (produced != output.mono.size() || output.pilot.size() != produced || output.difference.size() != produced ||
+        produced % demux.getHopSize() != 0 || produced + 2 * demux.getHopSize() + demux.getTapCount() < TOTAL_SAMPLES) {
+        std::printf("FAIL produced %zu samples per channel from %zu, hop %d\n", produced, TOTAL_SAMPLES,
+                    demux.getHopSize());
+        passed = false;
+    }
+
+    int delay = static_cast<int>(demux.getGroupDelaySamples());
+    double mono_db = errorDb(output.mono, &MPXComponents::mono, delay);
+    double pilot_db = errorDb(output.pilot, &MPXComponents::pilot, delay);
+    double difference_db = errorDb(output.difference, &MPXComponents::difference, delay);
+    std::printf("%d taps, FFT %d, hop %d, backend %s: error mono %.1f dB, pilot %.1f dB, L-R %.1f dB\n",
+                demux.getTapCount(), demux.getFFTSize(), demux.getHopSize(), demux.getFFTBackendName(), mono_db,
+                pilot_db, difference_db);
+
+    const struct { const char* name; double db; } errors[] = {
+        {"mono", mono_db}, {"pilot", pilot_db}, {"L-R", difference_db}};
+    for (const auto& e : errors) {
+        if (e.db > MAX_ERROR_DB) {
+            std::printf("FAIL %s error %.1f dB, expected <= %.1f dB\n", e.name, e.db, MAX_ERROR_DB);
+            passed = false;
+        }
+    }
+
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}